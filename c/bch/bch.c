@@ -0,0 +1,324 @@
+// -----------------------------------------------------------------------------
+// Binary BCH encoder and decoder functions, see bch.h
+//
+// The remainder of the division by bchGen is kept in nw 64-bit words, aligned
+// to the top: coefficient X^d is bit d + pad of the words (bit b in word
+// b / 64), pad = 64 * nw - nk.  So the highest bits, which are fed back, are
+// always at the top of word nw-1.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "bch.h"
+
+
+// -----------------------------------------------------------------------------
+// W = W * X^s, 0 < s < 64 (bits shifted out of the top are lost)
+// -----------------------------------------------------------------------------
+static inline void bchShl(uint64_t* W, int nw, int s)
+{
+	for (int w=nw-1; w>0; w--)
+		W[w] = (W[w] << s) | (W[w-1] >> (64 - s));
+	W[0] <<= s;
+}
+
+
+// -----------------------------------------------------------------------------
+// W ^= V
+// -----------------------------------------------------------------------------
+static inline void bchXor(uint64_t* W, const uint64_t* V, int nw)
+{
+	for (int w=0; w<nw; w++)
+		W[w] ^= V[w];
+}
+
+
+// Compute bchGen(X) = lcm(minimal polynomials of z^1 ... z^2t) into G[],
+// one coefficient per byte.
+// Return deg(bchGen).
+// -----------------------------------------------------------------------------
+static int bchGenPol(
+	int t,
+	uint8_t* G)		// out: G[deg] ... G[0], space for GF_N coeffs
+// -----------------------------------------------------------------------------
+{
+	const int m = GF_N - 1;
+	char done[GF_N];			// exponents whose minimal polynomial is in G
+	for (int c=0; c<m; c++)
+		done[c] = 0;
+	int nG = 0;
+	G[0] = 1;
+	for (int j=1; j<=2*t; j++) {
+		int c = j % m;
+		if (done[c])
+			continue;
+		// minimal polynomial of z^j: prod(X - z^c) over the cyclotomic coset
+		// c = j * 2^s (at most BITS_PER_SYMBOL of them), in exp. repr.:
+		gfExp M[BITS_PER_SYMBOL + 1];
+		int nM = 0;
+		M[0] = GF_1;
+		do {
+			done[c] = 1;
+			M[++nM] = GF_0;
+			for (int i=nM; i>0; i--)
+				M[i] = gfAdd(M[i-1], gfMul01(M[i], GF_Z(c)));
+			M[0] = gfMul01(M[0], GF_Z(c));
+			c = (2 * c) % m;
+		} while (! done[c]);
+		// its coeffs are 0 or 1, G = G * M over GF(2):
+		for (int i=nG+1; i<=nG+nM; i++)
+			G[i] = 0;
+		for (int i=nG; i>=0; i--) {
+			if (! G[i])
+				continue;
+			G[i] = 0;
+			for (int l=0; l<=nM; l++)
+				G[i + l] ^= (M[l] == GF_1);
+		}
+		nG += nM;
+		PRINTPOL("ini: M", M, nM);
+	}
+	return nG;
+}
+
+
+// Compute bchGen and the encoder tables:
+//   encTab[(j * 256 + b) * nw ...] = b * X^(nk + 8*j) % bchGen,  j = 0..3
+// (top aligned), so that 32 message bits are divided by 4 lookups.
+// -----------------------------------------------------------------------------
+int bchInit(
+	bchCodec* bch,	// out: codec
+	int k,			// in: number of information bits, k > 0
+	int t)			// in: number of correctable bits, t > 0
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- bchInit\n");
+
+	if ((k <= 0) || (t <= 0) || (k >= GF_N - 1))
+		return -1;
+
+	gfInit();
+
+	uint8_t G[GF_N];
+	int nk = bchGenPol(t, G);
+	if (k + nk >= GF_N)
+		return -1;
+	bch->n = k + nk;
+	bch->k = k;
+	bch->nk = nk;
+	bch->t = t;
+	const int nw = bch->nw = (nk + 63) / 64;
+
+	// tables and generator polynomial in one block:
+	uint64_t* mem = malloc(4 * 256 * nw * sizeof(uint64_t) + (nk + 8) / 8);
+	if (mem == NULL)
+		return -1;
+	bch->encTab = mem;
+	bch->gen = (uint8_t*) (mem + 4 * 256 * nw);
+	for (int i=nk/8; i>=0; i--)
+		bch->gen[i] = 0;
+	for (int i=nk; i>=0; i--)
+		bch->gen[i / 8] |= G[i] << (i % 8);
+
+	// X^(nk + s) % bchGen for s = 0..31, top aligned, starting with
+	// X^nk % bchGen = bchGen - X^nk:
+	const int pad = 64 * nw - nk;
+	uint64_t B[32][nw];
+	for (int w=0; w<nw; w++)
+		B[0][w] = 0;
+	for (int i=nk-1; i>=0; i--)
+		B[0][(i + pad) / 64] |= (uint64_t) G[i] << ((i + pad) % 64);
+	for (int s=1; s<32; s++) {
+		uint64_t fb = B[s-1][nw-1] >> 63;
+		for (int w=0; w<nw; w++)
+			B[s][w] = B[s-1][w];
+		bchShl(B[s], nw, 1);
+		if (fb)
+			bchXor(B[s], B[0], nw);
+	}
+	for (int j=0; j<4; j++) {
+		for (int b=0; b<256; b++) {
+			uint64_t* T = bch->encTab + (j * 256 + b) * nw;
+			for (int w=0; w<nw; w++)
+				T[w] = 0;
+			for (int l=0; l<8; l++)
+				if (b & (1 << l))
+					bchXor(T, B[8 * j + l], nw);
+		}
+	}
+	return 0;
+}
+
+
+// Free memory allocated by bchInit()
+// -----------------------------------------------------------------------------
+void bchFree(bchCodec* bch)
+// -----------------------------------------------------------------------------
+{
+	free(bch->encTab);
+	bch->encTab = NULL;
+	bch->gen = NULL;
+}
+
+
+// Remainder S = (X^nk * A(X)) % bchGen, bottom aligned (X^d is bit d of S)
+// -----------------------------------------------------------------------------
+static void bchRem(
+	const bchCodec* bch,
+	const uint8_t* A,	// in: info bits
+	uint64_t* S)		// out: remainder, nw words
+// -----------------------------------------------------------------------------
+{
+	const int nw = bch->nw;
+	const uint64_t* T0 = bch->encTab;
+	const uint64_t* T1 = T0 + 256 * nw;
+	const uint64_t* T2 = T1 + 256 * nw;
+	const uint64_t* T3 = T2 + 256 * nw;
+	for (int w=0; w<nw; w++)
+		S[w] = 0;
+	int i = bch->k;				// bits A[i-1] ... A[0] left
+	// partial top byte bit by bit (T0[1] = X^nk % bchGen):
+	for (; i%8; i--) {
+		uint64_t fb = (S[nw-1] >> 63) ^ ((A[(i - 1) / 8] >> ((i - 1) % 8)) & 1);
+		bchShl(S, nw, 1);
+		if (fb)
+			bchXor(S, T0 + nw, nw);
+	}
+	// 32 bits per step:
+	for (; i>=32; i-=32) {
+		const uint8_t* a = A + (i - 32) / 8;
+		uint32_t x = (uint32_t) (S[nw-1] >> 32)
+				   ^ (a[0] | a[1] << 8 | a[2] << 16 | (uint32_t) a[3] << 24);
+		if (nw > 1)
+			bchShl(S, nw, 32);
+		else
+			S[0] <<= 32;
+		bchXor(S, T0 + (x & 0xff) * nw, nw);
+		bchXor(S, T1 + ((x >> 8) & 0xff) * nw, nw);
+		bchXor(S, T2 + ((x >> 16) & 0xff) * nw, nw);
+		bchXor(S, T3 + (x >> 24) * nw, nw);
+	}
+	// the rest byte by byte:
+	for (; i>0; i-=8) {
+		uint32_t x = (S[nw-1] >> 56) ^ A[(i - 8) / 8];
+		bchShl(S, nw, 8);
+		bchXor(S, T0 + x * nw, nw);
+	}
+	// bottom align:
+	const int pad = 64 * nw - bch->nk;
+	if (pad == 0)
+		return;
+	for (int w=0; w<nw-1; w++)
+		S[w] = (S[w] >> pad) | (S[w+1] << (64 - pad));
+	S[nw-1] >>= pad;
+}
+
+
+// Compute check bits from information bits.
+// -----------------------------------------------------------------------------
+void bchEncode(
+	const bchCodec* bch,
+	const uint8_t* A,	// in: info bits    A[(k-1)/8] ... A[0]
+	uint8_t* R)			// out: check bits  R[(n-k-1)/8] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- bchEncode\n");
+	uint64_t S[bch->nw];
+	bchRem(bch, A, S);
+	for (int i=(bch->nk-1)/8; i>=0; i--)
+		R[i] = S[i / 8] >> (8 * (i % 8));
+}
+
+
+// C % bchGen = bchRem(A) + R
+// -----------------------------------------------------------------------------
+int bchRemainder(
+	const bchCodec* bch,
+	const uint8_t* A,	// in: info bits    A[(k-1)/8] ... A[0]
+	const uint8_t* R,	// in: check bits   R[(n-k-1)/8] ... R[0]
+	uint64_t* S)		// out: remainder, nw words
+// -----------------------------------------------------------------------------
+{
+	const int nk = bch->nk, nw = bch->nw;
+	bchRem(bch, A, S);
+	uint64_t nz = 0;
+	for (int i=(nk-1)/8; i>=0; i--)
+		S[i / 8] ^= (uint64_t) R[i] << (8 * (i % 8));
+	if (nk % 64)
+		S[nw-1] &= ((uint64_t) 1 << (nk % 64)) - 1;	// beyond R[nk-1]
+	for (int w=0; w<nw; w++)
+		nz |= S[w];
+	return nz != 0;
+}
+
+
+// Syndrome from the remainder, then bchCorrect()
+// -----------------------------------------------------------------------------
+int bchDecode(
+	const bchCodec* bch,
+	uint8_t* A,		// in/out: info bits    A[(k-1)/8] ... A[0]
+	uint8_t* R)		// in/out: check bits   R[(n-k-1)/8] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- bchDecode\n");
+	const int nk = bch->nk, nS = 2 * bch->t - 1;
+
+	// C(z^j) = (C % bchGen)(z^j), j = 1 ... 2t:
+	uint64_t S[bch->nw];
+	if (bchRemainder(bch, A, R, S) == 0)
+		return 0;
+	gfExp E[nk];
+	for (int i=nk-1; i>=0; i--)
+		E[i] = (S[i / 64] >> (i % 64)) & 1 ? GF_1 : GF_0;
+	gfVec Sv[nS + 1];
+	gfPolEvalSeq(E, nk - 1, Sv, nS, GF_Z(1));
+	gfExp Se[nS + 1];							// Se[j] = E(z^(j+1))
+	for (int j=0; j<=nS; j++)
+		Se[j] = gfV2E[Sv[nS - j]];
+	return bchCorrect(bch, Se, A, R);
+}
+
+
+// Berlekamp-Massey, Chien search
+// -----------------------------------------------------------------------------
+int bchCorrect(
+	const bchCodec* bch,
+	gfExp* S,		// in: syndrome S[2t-1] ... S[0]
+	uint8_t* A,		// in/out: info bits    A[(k-1)/8] ... A[0]
+	uint8_t* R)		// in/out: check bits   R[(n-k-1)/8] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	const int nk = bch->nk, nS = 2 * bch->t - 1;
+	PRINTPOL("bch: S", S, nS);
+
+	// error locator L(X) = c * prod(1 - z^i X) for errors at C[i]:
+	gfExp L[nS + 2], W[nS + 1], M[3 * (nS + 2)];
+	int nL, nW;
+	gfPolBM(S, nS, NULL, 0, L, &nL, W, &nW, M);
+	if ((nL <= 0) || (nL > bch->t))
+		return -1;
+	// Q(X) = X^nL * L(1/X) = c * prod(X - z^i), its roots within the codeword:
+	gfExp Q[nL + 1], X[nL];
+	for (int i=0; i<=nL; i++)
+		Q[i] = L[nL - i];
+	if (gfPolRoots(Q, nL, bch->n - 1, X, nL, M) != nL)
+		return -1;
+	int nInfo = 0;
+	for (int e=0; e<nL; e++) {
+		int i = X[e] - GF_Z(0);					// position
+		dprintf("Q(%d) = 0 => error at %d\n", X[e], i);
+		if (i < nk) {
+			R[i / 8] ^= 1 << (i % 8);
+		} else {
+			i -= nk;
+			A[i / 8] ^= 1 << (i % 8);
+			nInfo++;
+		}
+	}
+	return nInfo;
+}
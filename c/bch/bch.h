@@ -0,0 +1,112 @@
+// -----------------------------------------------------------------------------
+// Binary BCH encoder and decoder functions.
+//
+// Narrow-sense binary BCH code over the field of ecc_cfg.h: the generator
+// polynomial bchGen(X) has the 2t consecutive roots z^1 ... z^2t, so up to t
+// bit errors per codeword are corrected.  Its coefficients are bits, so it is
+// the product of the distinct minimal polynomials of z^1, z^3, ... z^(2t-1),
+// with deg(bchGen) <= BITS_PER_SYMBOL * t.
+//
+// Codewords are bit strings packed into bytes: bit i of a word (coefficient
+// of X^i) is bit i % 8 of byte i / 8.  Codeword C(X) = X^(n-k) * A(X) + R(X)
+// is passed as info part A and check part R, like rsEncodeV(), and n < GF_N.
+// The encoder divides by bchGen with tables, 32 message bits per step (8 for
+// the tail).  The decoder computes the syndrome from the remainder of the
+// codeword (no more than a re-encoding, if clean) and uses gfPolBM() and
+// gfPolRoots() of gf.c; all error values are 1.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#ifndef _BCH_H
+#define _BCH_H
+
+#include <ecc_cfg.h>
+#include <gf/gf.h>
+
+// Codec context.  Members are read-only for the user.
+typedef struct {
+	int		n;		// codeword length in bits, n < GF_N
+	int		k;		// number of information bits
+	int		nk;		// number of check bits n-k = deg(bchGen)
+	int		t;		// number of correctable bits
+	uint8_t* gen;	// bchGen, packed bits X^nk ... X^0 ((nk+8)/8 bytes)
+	int		nw;		// words per remainder, (nk+63)/64
+	uint64_t* encTab;// encoder tables, see bchInit()
+} bchCodec;
+
+
+// Initialize codec for t correctable bits and k information bits: compute
+// bchGen and the encoder tables.  The codeword length n = k + deg(bchGen) is
+// known afterwards.
+// Return 0 on success, -1 on invalid parameters (n >= GF_N), or if out of
+// memory.
+// -----------------------------------------------------------------------------
+int bchInit(
+	bchCodec* bch,	// out: codec
+	int k,			// in: number of information bits, k > 0
+	int t);			// in: number of correctable bits, t > 0
+// -----------------------------------------------------------------------------
+
+
+// Free memory allocated by bchInit()
+// -----------------------------------------------------------------------------
+void bchFree(bchCodec* bch);
+// -----------------------------------------------------------------------------
+
+
+// Compute check bits from information bits.
+// Bits of A above k-1 are ignored, those of R above n-k-1 are set to 0.
+// -----------------------------------------------------------------------------
+void bchEncode(
+	const bchCodec* bch,
+	const uint8_t* A,	// in: info bits    A[(k-1)/8] ... A[0]
+	uint8_t* R);		// out: check bits  R[(n-k-1)/8] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Correct codeword C = (A, R) in place, correcting up to t bit errors in A
+// and R.  A clean codeword is not written at all, nor is one detected to be
+// uncorrectable.
+// Bits of A and R above their length are ignored and left unchanged.
+// Reentrant, several threads may decode with the same codec.
+// Return number of corrected bits in the information part or -1, if the
+// codeword was detected to be uncorrectable.
+// -----------------------------------------------------------------------------
+int bchDecode(
+	const bchCodec* bch,
+	uint8_t* A,		// in/out: info bits    A[(k-1)/8] ... A[0]
+	uint8_t* R);	// in/out: check bits   R[(n-k-1)/8] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Remainder S(X) = C(X) % bchGen(X) of codeword C = (A, R), bit d of S holding
+// X^d (bit d % 64 of S[d / 64]), i.e. the check bits R + bchEncode(A) that
+// do not match.  It has the same syndrome as C.
+// Return 0 for a codeword without errors (S = 0), 1 otherwise.
+// -----------------------------------------------------------------------------
+int bchRemainder(
+	const bchCodec* bch,
+	const uint8_t* A,	// in: info bits    A[(k-1)/8] ... A[0]
+	const uint8_t* R,	// in: check bits   R[(n-k-1)/8] ... R[0]
+	uint64_t* S);		// out: remainder S[nw-1] ... S[0]
+// -----------------------------------------------------------------------------
+
+
+// Correct codeword C = (A, R) in place from its syndrome
+//   S[j] = C(z^(j+1)),  j = 0 ... 2t-1  (exp. repr., not all 0)
+// by Berlekamp-Massey and Chien search, as bchDecode() does once it has the
+// syndrome (e.g. for a syndrome computed elsewhere, see bch_slice.h).
+// Return as bchDecode().
+// -----------------------------------------------------------------------------
+int bchCorrect(
+	const bchCodec* bch,
+	gfExp* S,		// in: syndrome S[2t-1] ... S[0]
+	uint8_t* A,		// in/out: info bits    A[(k-1)/8] ... A[0]
+	uint8_t* R);	// in/out: check bits   R[(n-k-1)/8] ... R[0]
+// -----------------------------------------------------------------------------
+#endif	// _BCH_H
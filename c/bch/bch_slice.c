@@ -0,0 +1,315 @@
+// -----------------------------------------------------------------------------
+// Bit-sliced BCH decoding, see bch_slice.h
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include "bch_slice.h"
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+#define SW	(BCH_LANES / 64)	// words per slice
+#define SB	BITS_PER_SYMBOL		// slices per element
+
+// The bit-sliced Chien search of a block costs about tMax * SB^2 / 2 slice
+// XORs per location, whatever the number of codewords in it; that of one
+// codeword grows with deg(L).  Below this total of deg(L), the codewords are
+// searched one by one (bchCorrect()).
+#define SLICE_MIN(tMax)	((tMax) * SB * SB / 4 + 1)
+
+// one bit of each codeword of a block
+typedef struct {
+	uint64_t w[SW];
+} bchSl;
+
+
+// -----------------------------------------------------------------------------
+// D ^= S
+// -----------------------------------------------------------------------------
+static inline void slXor(bchSl* D, const bchSl* S)
+{
+	for (int w=0; w<SW; w++)
+		D->w[w] ^= S->w[w];
+}
+
+
+// -----------------------------------------------------------------------------
+// Element of lane s, vector repr.
+// -----------------------------------------------------------------------------
+static inline gfVec slGet(const bchSl* E, int s)
+{
+	gfVec v = 0;
+	for (int b=0; b<SB; b++)
+		v |= ((E[b].w[s / 64] >> (s % 64)) & 1) << b;
+	return v;
+}
+
+
+// -----------------------------------------------------------------------------
+// Set element of lane s (which is 0) to v
+// -----------------------------------------------------------------------------
+static inline void slSet(bchSl* E, int s, gfVec v)
+{
+	for (int b=0; b<SB; b++)
+		E[b].w[s / 64] |= (uint64_t) ((v >> b) & 1) << (s % 64);
+}
+
+
+// -----------------------------------------------------------------------------
+// E = E * c in all lanes, row r of M holds the bits of E that make bit r of
+// the product (see bchSliceMat())
+// -----------------------------------------------------------------------------
+static inline void slMulC(bchSl* E, const uint32_t* M)
+{
+	bchSl P[SB];
+	for (int r=0; r<SB; r++) {
+		for (int w=0; w<SW; w++)
+			P[r].w[w] = 0;
+		for (uint32_t x=M[r]; x; x&=x-1)
+			slXor(&P[r], &E[__builtin_ctz(x)]);
+	}
+	for (int r=0; r<SB; r++)
+		E[r] = P[r];
+}
+
+
+// -----------------------------------------------------------------------------
+// Matrix of the multiplication by c for slMulC()
+// -----------------------------------------------------------------------------
+static void bchSliceMat(gfExp c, uint32_t* M)
+{
+	for (int r=0; r<SB; r++)
+		M[r] = 0;
+	for (int b=0; b<SB; b++) {
+		gfVec col = gfE2V[gfMul11(gfV2E[1 << b], c)];	// c * (basis vector b)
+		for (int r=0; r<SB; r++)
+			M[r] |= ((col >> r) & 1u) << b;
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Transpose byte P[0] of nl codewords (at distance stride) into the slices
+// C[0] ... C[7] (bit l of the bytes), with 8 x 8 bit transposes.
+// -----------------------------------------------------------------------------
+static void bchTranspose(const uint8_t* P, int stride, int nl, bchSl* C)
+{
+	for (int l=0; l<8; l++)
+		for (int w=0; w<SW; w++)
+			C[l].w[w] = 0;
+	for (int s0=0; s0<nl; s0+=8) {
+		uint64_t x = 0;				// byte q: codeword s0 + q
+		for (int q=0; (q < 8) && (s0 + q < nl); q++)
+			x |= (uint64_t) P[(ptrdiff_t) (s0 + q) * stride] << (8 * q);
+		uint64_t t;					// now byte l: bit l of all 8 codewords
+		t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+		x ^= t ^ (t << 7);
+		t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+		x ^= t ^ (t << 14);
+		t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+		x ^= t ^ (t << 28);
+		for (int l=0; l<8; l++)
+			C[l].w[s0 / 64] |= ((x >> (8 * l)) & 0xff) << (s0 % 64);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Syndrome S[j-1] = C(z^j), j = 1 ... 2t of lane d from the odd ones Sy[u] =
+// C(z^(2u+1)), by S[2j-1] = S[j-1]^2
+// -----------------------------------------------------------------------------
+static void slSyndrome(bchSl Sy[][SB], int t, int d, gfExp* S)
+{
+	for (int j=1; j<=2*t; j++) {
+		if (j & 1)
+			S[j - 1] = gfV2E[slGet(Sy[j / 2], d)];
+		else
+			S[j - 1] = (S[j/2 - 1] == GF_0) ? GF_0 : gfMul11(S[j/2 - 1], S[j/2 - 1]);
+	}
+}
+
+
+// Decode one block of nl <= BCH_LANES codewords
+// -----------------------------------------------------------------------------
+static void bchSliceBlock(
+	const bchCodec* bch,
+	uint8_t* A,		// in/out: info bits of the 1st codeword
+	int aStride,
+	uint8_t* R,		// in/out: check bits of the 1st codeword
+	int rStride,
+	int nl,			// in: number of codewords
+	int* status)	// out: status per codeword
+// -----------------------------------------------------------------------------
+{
+	const int t = bch->t, nk = bch->nk, nw = bch->nw, m = GF_N - 1;
+
+	// ---------- remainders C % bchGen, those != 0 into lanes 0 ... nd-1:
+	// (the same syndrome as C, and nk instead of n bits to transpose)
+	uint8_t Rm[nl][8 * nw];			// remainder bytes of lane d
+	int cw[nl], nd = 0;				// codeword of lane d
+	for (int s=0; s<nl; s++) {
+		uint64_t S[nw];
+		status[s] = 0;
+		if (! bchRemainder(bch, A + (ptrdiff_t) s * aStride,
+						   R + (ptrdiff_t) s * rStride, S))
+			continue;
+		status[s] = -1;
+		for (int i=0; i<8*nw; i++)
+			Rm[nd][i] = S[i / 8] >> (8 * (i % 8));
+		cw[nd++] = s;
+	}
+	if (nd == 0)
+		return;
+
+	// ---------- odd syndromes Sy[u] = C(z^(2u+1)), sum of C[i] * z^(i*j):
+	bchSl Sy[t][SB];
+	int e[t], de[t];				// exponent i*j of the current position
+	for (int u=0; u<t; u++) {
+		for (int b=0; b<SB; b++)
+			for (int w=0; w<SW; w++)
+				Sy[u][b].w[w] = 0;
+		e[u] = 0;
+		de[u] = (2 * u + 1) % m;
+	}
+	for (int p=0; 8*p<nk; p++) {
+		bchSl C[8];
+		bchTranspose(&Rm[0][p], 8 * nw, nd, C);
+		for (int l=0; (l < 8) && (8 * p + l < nk); l++) {
+			uint64_t nz = 0;
+			for (int w=0; w<SW; w++)
+				nz |= C[l].w[w];
+			for (int u=0; u<t; u++) {
+				if (nz)
+					for (gfVec v=gfE2V[GF_Z(e[u])]; v; v&=v-1)
+						slXor(&Sy[u][__builtin_ctz(v)], &C[l]);
+				e[u] += de[u];
+				if (e[u] >= m)
+					e[u] -= m;
+			}
+		}
+	}
+
+	// ---------- error locators, one by one:
+	// Chien search with terms T[j] = L[j] * z^(-i*j) at position i, i.e.
+	// L(z^-i) = sum(T[j]) = 0 for an error at C[i]
+	bchSl T[t + 1][SB];
+	for (int j=0; j<=t; j++)
+		for (int b=0; b<SB; b++)
+			for (int w=0; w<SW; w++)
+				T[j][b].w[w] = 0;
+	bchSl active = {{0}};
+	int nL[nd], tMax = 0, sumL = 0, nActive = 0;
+	for (int d=0; d<nd; d++) {
+		gfExp S[2 * t], L[2 * t + 1], W[2 * t], M[3 * (2 * t + 1)];
+		int nW;
+		slSyndrome(Sy, t, d, S);
+		gfPolBM(S, 2 * t - 1, NULL, 0, L, &nL[d], W, &nW, M);
+		if ((nL[d] <= 0) || (nL[d] > t)) {
+			nL[d] = 0;					// status -1
+			continue;
+		}
+		for (int j=0; j<=nL[d]; j++)
+			slSet(T[j], d, gfE2V[L[j]]);
+		active.w[d / 64] |= (uint64_t) 1 << (d % 64);
+		tMax = (nL[d] > tMax) ? nL[d] : tMax;
+		sumL += nL[d];
+		nActive++;
+	}
+	if (nActive == 0)
+		return;
+	if (sumL < SLICE_MIN(tMax)) {
+		for (int d=0; d<nd; d++) {
+			if (nL[d] == 0)
+				continue;
+			gfExp S[2 * t];
+			slSyndrome(Sy, t, d, S);
+			const int s = cw[d];
+			status[s] = bchCorrect(bch, S, A + (ptrdiff_t) s * aStride,
+								   R + (ptrdiff_t) s * rStride);
+		}
+		return;
+	}
+
+	// ---------- bit-sliced Chien search:
+	uint32_t Mz[tMax + 1][SB];			// multiplication by z^-j
+	for (int j=1; j<=tMax; j++)
+		bchSliceMat(GF_Z((m - j % m) % m), Mz[j]);
+	int X[nd][tMax];					// error positions
+	int nX[nd];
+	for (int d=0; d<nd; d++)
+		nX[d] = 0;
+	for (int i=0; (i < bch->n) && nActive; i++) {
+		bchSl sum[SB];
+		for (int b=0; b<SB; b++) {
+			sum[b] = T[0][b];
+			for (int j=1; j<=tMax; j++)
+				slXor(&sum[b], &T[j][b]);
+		}
+		for (int w=0; w<SW; w++) {
+			uint64_t nz = 0;
+			for (int b=0; b<SB; b++)
+				nz |= sum[b].w[w];
+			for (uint64_t z=active.w[w]&~nz; z; z&=z-1) {
+				int d = 64 * w + __builtin_ctzll(z);
+				X[d][nX[d]++] = i;
+				if (nX[d] == nL[d]) {			// all roots found
+					active.w[w] &= ~(z & -z);
+					nActive--;
+				}
+			}
+		}
+		for (int j=1; j<=tMax; j++)
+			slMulC(T[j], Mz[j]);
+	}
+
+	// ---------- correct codewords with deg(L) roots:
+	for (int d=0; d<nd; d++) {
+		if ((nL[d] == 0) || (nX[d] != nL[d]))
+			continue;
+		const int s = cw[d];
+		uint8_t* As = A + (ptrdiff_t) s * aStride;
+		uint8_t* Rs = R + (ptrdiff_t) s * rStride;
+		int nInfo = 0;
+		for (int x=0; x<nX[d]; x++) {
+			int i = X[d][x];
+			if (i < nk) {
+				Rs[i / 8] ^= 1 << (i % 8);
+			} else {
+				i -= nk;
+				As[i / 8] ^= 1 << (i % 8);
+				nInfo++;
+			}
+		}
+		status[s] = nInfo;
+	}
+}
+
+
+// Decode cnt codewords in blocks of BCH_LANES
+// -----------------------------------------------------------------------------
+void bchDecodeSliced(
+	const bchCodec* bch,
+	uint8_t* A,		// in/out: info bits of the 1st codeword
+	int aStride,	// in: distance between info parts, min. (k+7)/8
+	uint8_t* R,		// in/out: check bits of the 1st codeword
+	int rStride,	// in: distance between check parts, min. (n-k+7)/8
+	int cnt,		// in: number of codewords
+	int* status)	// out: status per codeword; may be NULL
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- bchDecodeSliced\n");
+	int st[BCH_LANES];
+	for (int c0=0; c0<cnt; c0+=BCH_LANES) {
+		const int nl = MIN(BCH_LANES, cnt - c0);
+		bchSliceBlock(bch, A + (ptrdiff_t) c0 * aStride, aStride,
+					  R + (ptrdiff_t) c0 * rStride, rStride, nl, st);
+		if (status)
+			for (int s=0; s<nl; s++)
+				status[c0 + s] = st[s];
+	}
+}
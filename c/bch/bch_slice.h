@@ -0,0 +1,49 @@
+// -----------------------------------------------------------------------------
+// Bit-sliced BCH decoding of many codewords at once (e.g. all sectors of a
+// NAND page or block).
+//
+// Each codeword is checked first by its remainder C % bchGen (bchRemainder(),
+// table driven, as fast as encoding), so clean codewords cost no more than
+// with bchDecode().  The remainders of those with errors are transposed:
+// bit i of all of them forms one slice of BCH_LANES bits (lane d = d-th
+// codeword with errors), and a field element per lane is BITS_PER_SYMBOL
+// slices, one per bit of its vector representation.  The syndromes and the
+// Chien search are computed on these slices with XOR and AND only, so one
+// instruction works on all lanes of the block; the field enters as constants
+// only (multiplication by z^(i*j) while computing the syndromes, by z^-j in
+// the Chien search).
+// Only the Berlekamp-Massey algorithm runs per codeword.  With few errors in
+// the block, the Chien search runs per codeword as well (bchCorrect()).
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#ifndef _BCH_SLICE_H
+#define _BCH_SLICE_H
+
+#include <bch/bch.h>
+
+// codewords per block (bits per slice)
+#define BCH_LANES	256
+
+
+// Decode cnt codewords, like bchDecode() for each (with the same results),
+// in blocks of BCH_LANES.  Codeword c is (A + c * aStride, R + c * rStride),
+// so info and check bits may be interleaved (A = C + nR, R = C, aStride =
+// rStride) or kept apart, e.g. data and spare area of a NAND page.
+// status[c] receives the return value of bchDecode() for codeword c.
+// -----------------------------------------------------------------------------
+void bchDecodeSliced(
+	const bchCodec* bch,
+	uint8_t* A,		// in/out: info bits of the 1st codeword
+	int aStride,	// in: distance between info parts, min. (k+7)/8
+	uint8_t* R,		// in/out: check bits of the 1st codeword
+	int rStride,	// in: distance between check parts, min. (n-k+7)/8
+	int cnt,		// in: number of codewords
+	int* status);	// out: status per codeword; may be NULL
+// -----------------------------------------------------------------------------
+#endif	// _BCH_SLICE_H
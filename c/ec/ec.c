@@ -0,0 +1,363 @@
+// -----------------------------------------------------------------------------
+// Erasure coding of k data and m parity shards, see ec.h
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include "ec.h"
+
+#define W	BITS_PER_SYMBOL		// packets per block
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+
+// -----------------------------------------------------------------------------
+// Bit matrix of the multiplication by c: bit b of row r is set, if bit b of x
+// goes into bit r of c * x
+// -----------------------------------------------------------------------------
+static void ecBitMat(gfVec c, uint32_t* M)
+{
+	for (int r=0; r<W; r++)
+		M[r] = 0;
+	for (int b=0; b<W; b++) {
+		gfVec col = gfMulV(c, 1 << b);
+		for (int r=0; r<W; r++)
+			M[r] |= ((col >> r) & 1u) << b;
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Number of ones in the bit matrix of c, i.e. XORs to multiply by c
+// -----------------------------------------------------------------------------
+static int ecOnes(gfVec c)
+{
+	uint32_t M[W];
+	ecBitMat(c, M);
+	int ones = 0;
+	for (int r=0; r<W; r++)
+		ones += __builtin_popcount(M[r]);
+	return ones;
+}
+
+
+// Write the XOR schedule computing nr shards
+//   shard dst[o] = sum(C[o * ns + j] * shard src[j]),  j = 0 ... ns-1
+// to O[], room for nr * ns * W^2 steps.
+// Each packet of the results is a sum of source packets (a row of the bit
+// matrix); it is computed either from scratch, or from a packet computed
+// before, plus the source packets in which both differ, whatever takes fewer
+// steps.
+// Return number of steps, or -1 if out of memory.
+// -----------------------------------------------------------------------------
+static int ecSchedule(
+	int nr,				// in: number of shards to compute
+	const int* dst,		// in: their indices
+	int ns,				// in: number of source shards
+	const int* src,		// in: their indices
+	const gfVec* C,		// in: coefficients, nr rows of ns
+	ecOp* O)			// out: schedule
+// -----------------------------------------------------------------------------
+{
+	const int nq = nr * W, nb = ns * W;	// result and source packets
+	if (nq == 0)
+		return 0;
+	char (*B)[nb] = malloc((size_t) nq * nb);	// B[q][p]: packet p in q
+	if (B == NULL)
+		return -1;
+	for (int o=0; o<nr; o++) {
+		for (int j=0; j<ns; j++) {
+			uint32_t M[W];
+			ecBitMat(C[o * ns + j], M);
+			for (int r=0; r<W; r++)
+				for (int b=0; b<W; b++)
+					B[o * W + r][j * W + b] = (M[r] >> b) & 1;
+		}
+	}
+
+	int nO = 0;
+	for (int q=0; q<nq; q++) {
+		const int pq = dst[q / W] * W + q % W;
+		int cost = 0, from = -1;		// steps from scratch
+		for (int p=0; p<nb; p++)
+			cost += B[q][p];
+		for (int q0=0; q0<q; q0++) {
+			int d = 1;					// copy, then XOR differences
+			for (int p=0; (p < nb) && (d < cost); p++)
+				d += B[q][p] ^ B[q0][p];
+			if (d < cost) {
+				cost = d;
+				from = q0;
+			}
+		}
+		int copy = 1;
+		if (from >= 0) {
+			O[nO++] = (ecOp) {pq, dst[from / W] * W + from % W, 1};
+			copy = 0;
+		}
+		for (int p=0; p<nb; p++) {
+			if (B[q][p] ^ ((from >= 0) ? B[from][p] : 0)) {
+				O[nO++] = (ecOp) {pq, src[p / W] * W + p % W, copy};
+				copy = 0;
+			}
+		}
+		if (copy)						// not for a non-singular C
+			O[nO++] = (ecOp) {pq, pq, -1};
+	}
+	free(B);
+	dprintf("ec: %d packets in %d steps\n", nq, nO);
+	return nO;
+}
+
+
+// -----------------------------------------------------------------------------
+// d ^= s
+// -----------------------------------------------------------------------------
+static inline void ecXor(uint8_t* restrict d, const uint8_t* restrict s, size_t n)
+{
+	for (size_t i=0; i<n; i++)
+		d[i] ^= s[i];
+}
+
+
+// Run XOR schedule O[] on the shards S[], block by block
+// -----------------------------------------------------------------------------
+static void ecRun(
+	const ecOp* O,
+	int nO,
+	uint8_t** S,
+	size_t len)
+// -----------------------------------------------------------------------------
+{
+	for (size_t b0=0; b0<len; b0+=W*EC_PACKET) {
+		const size_t ps = MIN(W * EC_PACKET, len - b0) / W;	// packet size
+		for (int i=0; i<nO; i++) {
+			uint8_t* d = S[O[i].dst / W] + b0 + (O[i].dst % W) * ps;
+			const uint8_t* s = S[O[i].src / W] + b0 + (O[i].src % W) * ps;
+			if (O[i].copy > 0)
+				memcpy(d, s, ps);
+			else if (O[i].copy == 0)
+				ecXor(d, s, ps);
+			else
+				memset(d, 0, ps);
+		}
+	}
+}
+
+
+// Cauchy matrix Cij = 1 / (xi + yj) with xi = i, yj = m + j, scaled:
+// - column j by 1 / C0j, so row 0 is all 1 (identity bit matrices, that is
+//   parity shard 0 = XOR of the data shards),
+// - each further row by 1 / Cij for the j leaving the fewest ones in it.
+// Scaling rows and columns keeps all square submatrices non-singular, so any
+// k shards still restore the others.
+// -----------------------------------------------------------------------------
+int ecInit(
+	ecCodec* ec,	// out: codec
+	int k,			// in: number of data shards, k > 0
+	int m)			// in: number of parity shards, m > 0
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- ecInit\n");
+
+	if ((k <= 0) || (m <= 0) || (k + m > GF_N))
+		return -1;
+
+	gfInit();
+
+	ec->k = k;
+	ec->m = m;
+	ec->mat = malloc((size_t) m * k * sizeof(gfVec));
+	ec->enc = malloc((size_t) m * k * W * W * sizeof(ecOp));
+	if ((ec->mat == NULL) || (ec->enc == NULL)) {
+		ecFree(ec);
+		return -1;
+	}
+	gfVec* C = ec->mat;
+	for (int i=0; i<m; i++)
+		for (int j=0; j<k; j++)
+			C[i * k + j] = gfDivV(gfE2V[GF_1], (gfVec) (i ^ (m + j)));
+	for (int j=0; j<k; j++) {
+		const gfVec c0 = C[j];
+		for (int i=0; i<m; i++)
+			C[i * k + j] = gfDivV(C[i * k + j], c0);
+	}
+	for (int i=1; i<m; i++) {
+		gfVec* Ci = C + i * k;
+		int best = -1, jBest = 0;
+		for (int jd=0; jd<k; jd++) {
+			int ones = 0;
+			for (int j=0; j<k; j++)
+				ones += ecOnes(gfDivV(Ci[j], Ci[jd]));
+			if ((best < 0) || (ones < best)) {
+				best = ones;
+				jBest = jd;
+			}
+		}
+		const gfVec d = Ci[jBest];
+		for (int j=0; j<k; j++)
+			Ci[j] = gfDivV(Ci[j], d);
+	}
+
+	int dst[m], src[k];
+	for (int i=0; i<m; i++)
+		dst[i] = k + i;
+	for (int j=0; j<k; j++)
+		src[j] = j;
+	ec->nEnc = ecSchedule(m, dst, k, src, C, ec->enc);
+	if (ec->nEnc < 0) {
+		ecFree(ec);
+		return -1;
+	}
+	return 0;
+}
+
+
+// Free memory allocated by ecInit()
+// -----------------------------------------------------------------------------
+void ecFree(ecCodec* ec)
+// -----------------------------------------------------------------------------
+{
+	free(ec->mat);
+	free(ec->enc);
+	ec->mat = NULL;
+	ec->enc = NULL;
+}
+
+
+// Run the schedule of ecInit()
+// -----------------------------------------------------------------------------
+void ecEncode(
+	const ecCodec* ec,
+	uint8_t** S,	// in/out: k data shards, then m parity shards
+	size_t len)		// in: bytes per shard, a multiple of BITS_PER_SYMBOL
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- ecEncode\n");
+	ecRun(ec->enc, ec->nEnc, S, len);
+}
+
+
+// With e lost data shards l[a], restore them from the others D[j] and e
+// parity shards P[b] = sum(C[p[b]][j] * D[j]) that are left:
+//   sum(B[b][a] * D[l[a]]) = P[b] + sum(C[p[b]][j] * D[j], j not lost),
+// with the e x e submatrix B[b][a] = C[p[b]][l[a]], so
+//   D[l[a]] = sum(Binv[a][b] * P[b]) + sum(sum(Binv[a][b] * C[p[b]][j]) * D[j])
+// Then the lost parity shards from the data shards, as in ecEncode().
+// -----------------------------------------------------------------------------
+int ecDecode(
+	const ecCodec* ec,
+	uint8_t** S,		// in/out: k data shards, then m parity shards
+	const int* lost,	// in: indices of the lost shards in S
+	int nLost,			// in: number of lost shards, 0 ... m
+	size_t len)			// in: bytes per shard, a multiple of BITS_PER_SYMBOL
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- ecDecode\n");
+	const int k = ec->k, m = ec->m;
+	const gfVec* C = ec->mat;
+
+	if ((nLost < 0) || (nLost > m))
+		return -1;
+	char isLost[k + m];
+	for (int s=0; s<k+m; s++)
+		isLost[s] = 0;
+	for (int e=0; e<nLost; e++) {
+		if ((lost[e] < 0) || (lost[e] >= k + m) || isLost[lost[e]])
+			return -1;
+		isLost[lost[e]] = 1;
+	}
+	if (nLost == 0)
+		return 0;
+	gfVec* D = malloc((size_t) nLost * k * sizeof(gfVec));	// coefficients
+	ecOp* O = malloc((size_t) nLost * k * W * W * sizeof(ecOp));
+	if ((D == NULL) || (O == NULL)) {
+		free(D);
+		free(O);
+		return -1;
+	}
+
+	// ---------- lost data shards l[], parity shards p[] to restore them:
+	int l[nLost], p[nLost], lp[nLost], e = 0, nlp = 0;
+	for (int s=0; s<k; s++)
+		if (isLost[s])
+			l[e++] = s;
+	for (int i=0, b=0; i<m; i++) {
+		if (isLost[k + i])
+			lp[nlp++] = k + i;
+		else if (b < e)
+			p[b++] = i;
+	}
+
+	// ---------- Binv by Gauss-Jordan elimination of (B | I):
+	gfVec G[e][2 * e];
+	for (int b=0; b<e; b++)
+		for (int a=0; a<e; a++) {
+			G[b][a] = C[p[b] * k + l[a]];
+			G[b][e + a] = (a == b) ? gfE2V[GF_1] : GF_0;
+		}
+	for (int c=0; c<e; c++) {
+		int piv = c;
+		while ((piv < e) && (G[piv][c] == GF_0))
+			piv++;
+		if (piv == e) {						// not for a Cauchy matrix
+			free(D);
+			free(O);
+			return -1;
+		}
+		for (int x=0; x<2*e; x++) {
+			gfVec tmp = G[c][x];
+			G[c][x] = G[piv][x];
+			G[piv][x] = tmp;
+		}
+		const gfVec d = G[c][c];
+		for (int x=0; x<2*e; x++)
+			G[c][x] = gfDivV(G[c][x], d);
+		for (int r=0; r<e; r++) {
+			const gfVec f = G[r][c];
+			if ((r == c) || (f == GF_0))
+				continue;
+			for (int x=0; x<2*e; x++)
+				G[r][x] = gfAddV(G[r][x], gfMulV(f, G[c][x]));
+		}
+	}
+
+	// ---------- coefficients of the lost data shards over k sources (the
+	// data shards left, then the parity shards p[]), and of the lost parity:
+	int src[k], data[k];
+	for (int s=0, ns=0; s<k; s++) {
+		data[s] = s;
+		if (! isLost[s])
+			src[ns++] = s;
+	}
+	for (int b=0; b<e; b++)
+		src[k - e + b] = k + p[b];
+	for (int a=0; a<e; a++) {
+		gfVec* Da = D + a * k;
+		for (int x=0; x<k-e; x++) {
+			gfVec c = GF_0;
+			for (int b=0; b<e; b++)
+				c = gfAddV(c, gfMulV(G[a][e + b], C[p[b] * k + src[x]]));
+			Da[x] = c;
+		}
+		for (int b=0; b<e; b++)
+			Da[k - e + b] = G[a][e + b];
+	}
+	for (int x=0; x<nlp; x++)
+		for (int j=0; j<k; j++)
+			D[(e + x) * k + j] = C[(lp[x] - k) * k + j];
+
+	int nO = ecSchedule(e, l, k, src, D, O);
+	int nP = (nO < 0) ? -1 : ecSchedule(nlp, lp, k, data, D + e * k, O + nO);
+	if (nP >= 0)
+		ecRun(O, nO + nP, S, len);
+	free(D);
+	free(O);
+	return (nP < 0) ? -1 : 0;
+}
@@ -0,0 +1,98 @@
+// -----------------------------------------------------------------------------
+// Erasure coding of k data shards with m parity shards (e.g. the pieces of an
+// object spread over k+m nodes): any k of the k+m shards restore the others.
+//
+// The code is systematic, parity shard i = sum(Cij * data shard j), with a
+// Cauchy matrix C over the field of ecc_cfg.h (so k + m <= GF_N), whose rows
+// and columns are scaled for few ones in its bit matrices (see ecInit()).
+// Each shard is cut into blocks of BITS_PER_SYMBOL packets, and multiplying by
+// Cij becomes a BITS_PER_SYMBOL x BITS_PER_SYMBOL bit matrix telling which
+// data packets to XOR into which parity packets ("Cauchy Reed-Solomon").  So
+// encoding and decoding are XORs of whole packets only, done in the order of
+// an XOR schedule that computes a packet from a similar one done before, if
+// that takes fewer XORs.  The schedule runs on one block of all shards before
+// the next, so the packets it works on stay in the cache.
+//
+// Shards are byte buffers of len bytes each, len a multiple of
+// BITS_PER_SYMBOL.  Full blocks have BITS_PER_SYMBOL * EC_PACKET bytes, the
+// last block of a shard may be shorter (with shorter packets).
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#ifndef _EC_H
+#define _EC_H
+
+#include <stddef.h>
+#include <ecc_cfg.h>
+#include <gf/gf.h>
+
+// bytes per packet of a full block: the k+m blocks worked on at a time take
+// (k + m) * BITS_PER_SYMBOL * EC_PACKET bytes
+#ifndef EC_PACKET
+  #define EC_PACKET	512
+#endif
+
+// One step of an XOR schedule, on packets p = shard * BITS_PER_SYMBOL + i
+// (packet i of the current block of a shard)
+typedef struct {
+	int		dst;	// packet dst ^= packet src,
+	int		src;
+	int		copy;	// 1: packet dst = packet src instead, -1: dst = 0
+} ecOp;
+
+// Codec context.  Members are read-only for the user.
+typedef struct {
+	int		k;		// number of data shards
+	int		m;		// number of parity shards
+	gfVec*	mat;	// C, m rows of k coefficients
+	ecOp*	enc;	// XOR schedule of ecEncode()
+	int		nEnc;	// its number of steps
+} ecCodec;
+
+
+// Initialize codec for k data and m parity shards: compute C and the XOR
+// schedule of the encoder.
+// Return 0 on success, -1 on invalid parameters (k + m > GF_N), or if out of
+// memory.
+// -----------------------------------------------------------------------------
+int ecInit(
+	ecCodec* ec,	// out: codec
+	int k,			// in: number of data shards, k > 0
+	int m);			// in: number of parity shards, m > 0
+// -----------------------------------------------------------------------------
+
+
+// Free memory allocated by ecInit()
+// -----------------------------------------------------------------------------
+void ecFree(ecCodec* ec);
+// -----------------------------------------------------------------------------
+
+
+// Compute parity shards S[k] ... S[k+m-1] from data shards S[0] ... S[k-1].
+// -----------------------------------------------------------------------------
+void ecEncode(
+	const ecCodec* ec,
+	uint8_t** S,	// in/out: k data shards, then m parity shards
+	size_t len);	// in: bytes per shard, a multiple of BITS_PER_SYMBOL
+// -----------------------------------------------------------------------------
+
+
+// Restore the nLost shards lost[] (data or parity, in any order) from the
+// others, which are not written.  The content of the lost shards is ignored.
+// Reentrant, several threads may decode with the same codec.
+// Return 0 on success, -1 if nLost > m, lost[] has invalid or repeated
+// entries, or if out of memory.
+// -----------------------------------------------------------------------------
+int ecDecode(
+	const ecCodec* ec,
+	uint8_t** S,		// in/out: k data shards, then m parity shards
+	const int* lost,	// in: indices of the lost shards in S
+	int nLost,			// in: number of lost shards, 0 ... m
+	size_t len);		// in: bytes per shard, a multiple of BITS_PER_SYMBOL
+// -----------------------------------------------------------------------------
+#endif	// _EC_H
@@ -3,9 +3,7 @@
 #ifndef _ECC_CFG_H
 #define _ECC_CFG_H
 
-// pick one:
-// =========
-#include "ecc_cfg_rs.h"
-// #include "ecc_cfg_bch.h"	// NOT YET IMPLEMENTED !!
+#include "ecc_cfg_rs.h"		// field size, Reed-Solomon defaults
+#include "ecc_cfg_bch.h"	// BCH defaults, same field
 
 #endif
@@ -9,43 +9,42 @@
 // user params:
 // -----------------------------------------------------------------------------
 
-#error "BCH not yet implemented."
-
-// Codeword length (info + check part) in bits:
-// (usually 2^n - 1)
-#define BITS_PER_CODEWORD 15
+// Binary BCH codes use the field of ecc_cfg_rs.h (BITS_PER_SYMBOL): a codeword
+// has less than GF_N bits, e.g. GF(2^13) for 512 byte sectors, GF(2^16) for
+// 4 KB sectors.
+// Default code geometry, as used by the test code.  Each bchCodec chooses its
+// own geometry at runtime, see bchInit().
 
 // Number of bits that can be corrected:
-// (Generator polynomial will have 2x that many *consecutive* roots; degree not yet known)
-#define CORRECTABLE_BITS 2
-
-
-
-
-#if (BITS_PER_CODEWORD < 8)
- #define GF_N 8
-#elif (BITS_PER_CODEWORD < 16)
- #define GF_N 16
-#elif (BITS_PER_CODEWORD < 32)
- #define GF_N 32
-#elif (BITS_PER_CODEWORD < 64)
- #define GF_N 64
-#elif (BITS_PER_CODEWORD < 128)
- #define GF_N 128
-#elif (BITS_PER_CODEWORD < 256)
- #define GF_N 256
-#elif (BITS_PER_CODEWORD < 512)
- #define GF_N 512
-#elif (BITS_PER_CODEWORD < 1024)
- #define GF_N 1024
-#elif (BITS_PER_CODEWORD < 2048)
- #define GF_N 2048
-#else
- #error "invalid config"
+// (Generator polynomial will have 2x that many *consecutive* roots)
+#ifndef CORRECTABLE_BITS
+ #define CORRECTABLE_BITS 2
+#endif
+
+// Number of information bits per codeword.  The codeword gets deg(bchGen) <=
+// BITS_PER_SYMBOL * CORRECTABLE_BITS check bits more.  If not defined, the
+// longest code (for deg(bchGen) = BITS_PER_SYMBOL * CORRECTABLE_BITS) is used.
+// #define INFO_BITS_PER_CODEWORD 4096		// custom value (512 byte sector)
+#ifndef INFO_BITS_PER_CODEWORD
+ #define INFO_BITS_PER_CODEWORD (GF_N - 1 - BITS_PER_SYMBOL * CORRECTABLE_BITS)
 #endif
 
-#define BCH_N BITS_PER_CODEWORD
 
-// TODO
+
+
+// -----------------------------------------------------------------------------
+// derived params:
+// -----------------------------------------------------------------------------
+
+// shortcuts:
+#define BCH_K (INFO_BITS_PER_CODEWORD)
+#define BCH_T (CORRECTABLE_BITS)
+
+// sanity checks (the length of the check part is known at runtime only):
+#if (BCH_K <= 0) || (BCH_K >= GF_N - 1)
+  #error "invalid config"
+#elif (BCH_T <= 0)
+  #error "invalid config"
+#endif
 
 #endif // _ECC_CFG_BCH_H
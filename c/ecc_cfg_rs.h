@@ -9,8 +9,13 @@
 // user params:
 // -----------------------------------------------------------------------------
 
-// Symbol size:
-#define BITS_PER_SYMBOL 4
+// Symbol size (fixed at compile time):
+#ifndef BITS_PER_SYMBOL
+ #define BITS_PER_SYMBOL 4
+#endif
+
+// Default code geometry, as used by the test code.  Each rsCodec chooses its
+// own geometry at runtime, see rsInit().
 
 // Codeword length (info + check part).  If not defined, the maximum length of
 //  2 ^ BITS_PER_SYMBOL - 1
@@ -18,7 +23,9 @@
 // #define SYMBOLS_PER_CODEWORD 12		// custom value
 
 // Number of redundant check symbols per codeword (min: 1):
-#define CHECK_SYMBOLS_PER_CODEWORD 4
+#ifndef CHECK_SYMBOLS_PER_CODEWORD
+ #define CHECK_SYMBOLS_PER_CODEWORD 4
+#endif
 
 
 
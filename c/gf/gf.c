@@ -10,19 +10,74 @@
 // published by the Free Software Foundation.
 // -----------------------------------------------------------------------------
 
+#include <stddef.h>
 #include "gf.h"
 
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 
+#ifdef GF_GEN
 gfVec gfE2V[GF_N];
 gfExp gfV2E[GF_N];
+#if (GF_N <= 256)
+uint8_t gfNib[GF_N][32];
+#endif
+#if (GF_ARITH == GF_ARITH_ZECH)
+gfExp zechLog[GF_N];
+#elif (GF_ARITH == GF_ARITH_TAB)
+gfExp gfMulTab[GF_N][GF_N];
+#endif
+#if (GF_N > 256)
+uint32_t gfClK[3];
+#endif
+#else
+// page aligned, so that the tables share no page with writable data:
+#ifdef __GNUC__
+  #define GF_PAGE_ALIGNED __attribute__((aligned(4096)))
+#else
+  #define GF_PAGE_ALIGNED
+#endif
+#include <gf_tab.h>		// generated by gf_gen
+#endif
+
+// external definitions of the basic operations, for calls the compiler does
+// not inline (C99), e.g. the bigger ones of some GF_ARITH back-ends:
+extern inline gfExp gfMul11(gfExp a, gfExp b);
+extern inline gfExp gfMul01(gfExp a, gfExp b);
+extern inline gfExp gfMul(gfExp a, gfExp b);
+extern inline gfExp gfDiv1(gfExp a, gfExp b);
+extern inline gfExp gfInv1(gfExp a);
+extern inline gfExp gfDiv(gfExp a, gfExp b);
+extern inline gfExp gfAdd(gfExp a, gfExp b);
+extern inline gfVec gfMulV(gfVec a, gfVec b);
+extern inline gfVec gfDivV(gfVec a, gfVec b);
+
+#if (GF_N > 256) && (defined(GF_GEN) || ! defined(__PCLMUL__))
+// -----------------------------------------------------------------------------
+// carry-less product a * b, deg(a) + deg(b) < 64 (portable, slow)
+// -----------------------------------------------------------------------------
+static uint64_t gfClMulSw(uint64_t a, uint64_t b)
+{
+	uint64_t r = 0;
+	for (; b; b>>=1, a<<=1)
+		if (b & 1)
+			r ^= a;
+	return r;
+}
+#endif
 
 // -----------------------------------------------------------------------------
 // initialize LUTs gfExp <-> gfVec
+// Calling it again is harmless, tables are computed only once.
 // -----------------------------------------------------------------------------
 int gfInit()
 {
+#ifndef GF_GEN
+	return 0;					// generated at build time
+#else
+	if (gfV2E[GF_1] != GF_0)	// already done
+		return 0;
+
 	// without X^n, X^(n-1) at bit 0
 	#if (GF_N == 8)
 		#define GFPOL 0x6	//                 110 (1): (x^3) + x + 1
@@ -59,7 +114,7 @@ int gfInit()
 	gfE2V[0] = 0;
 	gfV2E[0] = 0;
 	gfVec v = GF_N >> 1;
-	for (gfExp e=0; e<GF_N-1; e++) {	// z^e, represented as e+1
+	for (int e=0; e<GF_N-1; e++) {	// z^e, represented as e+1
 		int c = v & 1;
 		v >>= 1;
 		if (c)
@@ -67,6 +122,53 @@ int gfInit()
 		gfE2V[e+1] = v;
 		gfV2E[v] = e+1;
 	}
+
+  #if (GF_N <= 256)
+	// split-nibble tables for the region operations:
+	for (int c=0; c<GF_N; c++) {
+		for (int i=0; i<16; i++) {
+			int lo = i;
+			int hi = i << 4;
+			gfNib[c][i]      = (lo < GF_N) ? gfE2V[gfMul(c, gfV2E[lo])] : 0;
+			gfNib[c][16 + i] = (hi < GF_N) ? gfE2V[gfMul(c, gfV2E[hi])] : 0;
+		}
+	}
+  #endif
+
+	// tables of the arithmetic back-end:
+  #if (GF_ARITH == GF_ARITH_ZECH)
+	for (int a=0; a<GF_N; a++)
+		zechLog[a] = gfAdd(GF_1, a);
+  #elif (GF_ARITH == GF_ARITH_TAB)
+	for (int a=0; a<GF_N; a++)
+		for (int b=0; b<GF_N; b++)
+			gfMulTab[a][b] = gfMul(a, b);
+  #endif
+
+  #if (GF_N > 256)
+	// constants of the carry-less multiplication, see gfClPrep():
+	const int n = BITS_PER_SYMBOL;
+	uint64_t P = ((uint64_t) GFPOL << 1) | 1;		// P*(y), y = 1/x
+	uint64_t mu = 0, r = 1ull << (2 * n);
+	for (int i=n; i>=0; i--) {						// floor(y^2n / P*)
+		if (r & (1ull << (n + i))) {
+			mu |= 1ull << i;
+			r ^= P << i;
+		}
+	}
+	uint64_t y1 = 1;								// y^-(n-2), y^-1 = P* >> 1
+	for (int i=0; i<n-2; i++) {
+		y1 = gfClMulSw(y1, P >> 1);
+		for (int d=2*n-2; d>=n; d--)
+			if (y1 & (1ull << d))
+				y1 ^= P << (d - n);
+	}
+	gfClK[0] = P;
+	gfClK[1] = mu;
+	gfClK[2] = y1;
+  #endif
+	return 0;
+#endif
 }
 
 
@@ -212,6 +314,18 @@ int gfPolDiv1(
 	PRINTPOL("div: A", A, nA);
 	PRINTPOL("div: B", B, nB);
 
+  #if (GF_N <= 256)
+	// synthetic division on a copy of A in vector representation:
+	uint8_t W[nA + 1];
+	uint8_t Bv[nB];
+	for (int i=nA; i>=0; i--)
+		W[i] = gfE2V[A[i]];
+	for (int i=nB-1; i>=0; i--)
+		Bv[i] = gfE2V[B[i]];
+	gfPolDiv1V(W, nA, Bv, nB);
+	for (int i=nB-1; i>=0; i--)
+		R[i] = gfV2E[W[i]];
+  #else
 	// remainder is more efficient in vector representation:
 	gfVec* Rv = R;
 	// use upper numerator coeffs as initial remainder:
@@ -235,6 +349,7 @@ int gfPolDiv1(
 
 	// convert result back to exponent representation:
 	gfPolV2E(Rv, R, nB-1);
+  #endif
 
 	PRINTPOL("div: R", R, nB-1);
 	return nB;
@@ -399,8 +514,9 @@ gfExp* gfPolDivEEA(
 //   P * N' = Q * A' = lcm(N', A')
 // and
 //   gcd(P, Q) = 1
+// Return the number of iterations (polynomial divisions).
 // -----------------------------------------------------------------------------
-void gfPolEEA(
+int gfPolEEA(
 	gfExp*	N,	// in; only highest coeffs of N'
 	int		nN,	// in: actual deg(N)
 	gfExp*	A,	// in; only highest coeffs of A'
@@ -448,7 +564,9 @@ void gfPolEEA(
 	D2[0] = GF_0;	nD2 = -1;			// D2 = 0
 	// -------------------- loop: --------------------
 	nTQ = *nQ;
+	int it = 0;
 	while (1) {					// while (R1 != 0)
+		it++;
 		PRINTPOL("EEA1: R2", R2, nR2);
 		PRINTPOL("EEA1: R1", R1, nR1);
 
@@ -503,6 +621,104 @@ void gfPolEEA(
 	}
 	PRINTPOL("EEA: P", P, *nP);
 	PRINTPOL("EEA: Q", Q, *nQ);
+	return it;
+}
+
+
+// -----------------------------------------------------------------------------
+// Inversionless Berlekamp-Massey algorithm (iBM, see D. Sarwate, N. Shanbhag:
+// High-Speed Architectures for Reed-Solomon Decoders).  The usual division by
+// the previous discrepancy is avoided by scaling L with g instead:
+//
+//   L = 1, B = 1, nL = 0, g = 1
+//   for r = 0 ... nS:
+//     d = sum(L[i] * S[r-i]), i=0..nL        (discrepancy)
+//     T = g * L - d * X * B
+//     if (d != 0) and (2 * nL <= r):  B = L, nL = r+1 - nL, g = d
+//     else:                           B = X * B
+//     L = T
+//   W = S * L mod X^nL
+// With erasures, L, B start with the erasure locator G, nL = deg(G), r starts
+// at deg(G), and the length changes if 2 * nL <= r + nG to r+1 + nG - nL
+// (see R. Blahut: Algebraic Codes for Data Transmission).
+//
+// B is kept as X^s * B0 (no shifting), L, B0 and T are rotating pointers into
+// M.  Only coeffs up to the actual degrees dL, dB0 are touched, so the costs
+// grow with the number of errors rather than with nS.
+// -----------------------------------------------------------------------------
+int gfPolBM(
+	gfExp*	S,	// in: syndrome S[0] ... S[nS]
+	int		nS,	// in: max. deg(S) (number of syndromes - 1)
+	gfExp*	G,	// in: erasure locator prod(1 - Xi * X), may be NULL if nG = 0
+	int		nG,	// in: deg(G) = number of erasures, nG <= nS+1
+	gfExp*	L,	// out: error locator, size nS + 2; may be the same as G
+	int		*nL,// out: deg(L) = length of the LFSR (L[nL] may be 0)
+	gfExp*	W,	// out: error evaluator, size nS + 1
+	int		*nW,// out: max. deg(W) = nL - 1
+	gfExp*	M)	// free memory of size: 3 * (nS+2)
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- polBM\n");
+	PRINTPOL("BM: S", S, nS);
+	gfExp* Lr = M;		M += nS + 2;
+	gfExp* B0 = M;		M += nS + 2;
+	gfExp* T  = M;
+	Lr[0] = B0[0] = GF_1;
+	for (int i=1; i<=nG; i++)
+		Lr[i] = B0[i] = G[i];
+	int dL = nG, dB0 = nG;		// actual degrees
+	int s = 0;					// B = X^s * B0
+	int l = nG;					// LFSR length
+	gfExp g = GF_1;
+	int r;
+	for (r=nG; r<=nS; r++) {
+		// discrepancy (vector repr.):
+		gfVec dv = GF_0;
+		for (int i=MIN(dL, r); i>=0; i--)
+			dv ^= gfE2V[gfMul(Lr[i], S[r-i])];
+		gfExp d = gfV2E[dv];
+		s++;					// B = X * B, also for T below
+		if (d == GF_0)
+			continue;			// T = g * L: no need to scale L
+		// T = g * L - d * X^s * B0:
+		int dT = MAX(dL, s + dB0);
+		for (int i=dT; i>=0; i--) {
+			gfVec tv = GF_0;
+			if (i <= dL)
+				tv = gfE2V[gfMul01(Lr[i], g)];
+			if ((i >= s) && (i - s <= dB0))
+				tv ^= gfE2V[gfMul(B0[i - s], d)];
+			T[i] = gfV2E[tv];
+		}
+		while ((dT > 0) && (T[dT] == GF_0))
+			dT--;
+		gfExp* t = Lr;			// buffer that becomes free
+		if (2 * l <= r + nG) {
+			l = r + 1 + nG - l;
+			g = d;
+			t = B0;
+			B0 = Lr;			// B = old L
+			dB0 = dL;
+			s = 0;
+		}
+		Lr = T;
+		dL = dT;
+		T = t;
+	}
+	// copy L (deg(L) may be < l), compute W = S * L mod X^l:
+	for (int i=l; i>=0; i--)
+		L[i] = i <= dL ? Lr[i] : GF_0;
+	for (int i=l-1; i>=0; i--) {
+		gfVec wv = GF_0;
+		for (int j=MIN(i, dL); j>=0; j--)
+			wv ^= gfE2V[gfMul(L[j], S[i-j])];
+		W[i] = gfV2E[wv];
+	}
+	*nL = l;
+	*nW = l - 1;
+	PRINTPOL("BM: L", L, *nL);
+	PRINTPOL("BM: W", W, *nW);
+	return r - nG;
 }
 
 
@@ -541,3 +757,754 @@ gfExp gfPolEvalDeriv(
 	return r;
 }
 
+
+
+// -----------------------------------------------------------------------------
+// Chien search: at location z^i, the terms A[j] * z^(i*j) are updated from
+// those at z^(i+1) with one multiplication each: * z^(-j)
+// -----------------------------------------------------------------------------
+int gfPolRoots(
+	gfExp*	A,	// polynomial
+	int		nA,	// max. deg(A)
+	int		nY,	// highest location z^nY, nY < GF_N-1
+	gfExp*	R,	// out: roots, max. nR
+	int		nR,	// in: max. number of roots to find
+	gfExp*	M)	// free memory of size: 2 * (nA+1)
+// -----------------------------------------------------------------------------
+{
+	gfExp* t = M;			// terms at the current location
+	gfExp* d = M + nA + 1;	// step z^(-j)
+	gfExp zY = GF_Z(nY);
+	gfExp x = GF_1;			// (z^nY)^j
+	for (int j=0; j<=nA; j++) {
+		t[j] = gfMul01(A[j], x);
+		d[j] = GF__Z(-j);
+		x = gfMul11(x, zY);
+	}
+	int nX = 0;
+	for (int i=nY; i>=0; i--) {
+		gfVec s = GF_0;
+		for (int j=nA; j>=0; j--) {
+			s ^= gfE2V[t[j]];
+			t[j] = gfMul01(t[j], d[j]);
+		}
+		if (s == GF_0) {
+			R[nX++] = GF_Z(i);
+			if (nX == nR)
+				break;
+		}
+	}
+	return nX;
+}
+
+
+#if (GF_N <= 256)
+// =============================================================================
+// region operations:
+// =============================================================================
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+#elif defined(__SSSE3__)
+  #include <tmmintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// dst ^= c * src
+// Split-nibble method: c * v = c * (v & 15) + c * (v & 0xf0), each of both
+// products is a 16 entry table lookup, which is exactly what the (V)PSHUFB
+// instruction does on 16 bytes in parallel.
+// -----------------------------------------------------------------------------
+void gfRegionMulAdd(
+	uint8_t*		dst,	// in/out: region, vector repr.
+	const uint8_t*	src,	// in: region, vector repr.
+	gfExp			c,		// in: factor, exponent repr.
+	int				len)	// in: number of symbols
+// -----------------------------------------------------------------------------
+{
+	if (c == GF_0)
+		return;
+	const uint8_t* T = gfNib[c];
+	int i = 0;
+  #if defined(__AVX2__)
+	__m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) T));
+	__m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) (T + 16)));
+	__m256i m4 = _mm256_set1_epi8(0x0f);
+	for (; i+32<=len; i+=32) {
+		__m256i v  = _mm256_loadu_si256((const __m256i*) (src + i));
+		__m256i lo = _mm256_and_si256(v, m4);
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi64(v, 4), m4);
+		__m256i p  = _mm256_xor_si256(_mm256_shuffle_epi8(tlo, lo),
+									  _mm256_shuffle_epi8(thi, hi));
+		__m256i d  = _mm256_loadu_si256((const __m256i*) (dst + i));
+		_mm256_storeu_si256((__m256i*) (dst + i), _mm256_xor_si256(d, p));
+	}
+  #endif
+  #if defined(__SSSE3__)
+	__m128i tlo1 = _mm_loadu_si128((const __m128i*) T);
+	__m128i thi1 = _mm_loadu_si128((const __m128i*) (T + 16));
+	__m128i m41 = _mm_set1_epi8(0x0f);
+	for (; i+16<=len; i+=16) {
+		__m128i v  = _mm_loadu_si128((const __m128i*) (src + i));
+		__m128i lo = _mm_and_si128(v, m41);
+		__m128i hi = _mm_and_si128(_mm_srli_epi64(v, 4), m41);
+		__m128i p  = _mm_xor_si128(_mm_shuffle_epi8(tlo1, lo),
+								   _mm_shuffle_epi8(thi1, hi));
+		__m128i d  = _mm_loadu_si128((const __m128i*) (dst + i));
+		_mm_storeu_si128((__m128i*) (dst + i), _mm_xor_si128(d, p));
+	}
+  #endif
+	for (; i<len; i++) {
+		uint8_t v = src[i];
+		dst[i] ^= T[v & 15] ^ T[16 + (v >> 4)];
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// In-place synthetic division with normalized B.  Each step subtracts q * B
+// from the current top coeffs with one region operation:
+//   A[iq+nB-1 .. iq] -= q * B[nB-1 .. 0],   q = A[iq+nB]
+// A[iq+nB] is not touched anymore and is the quotient coeff q.
+// -----------------------------------------------------------------------------
+void gfPolDiv1V(
+	uint8_t*		Av,	// in: numerator; out: quotient and remainder
+	int				nA,	// in: max. deg(A)
+	const uint8_t*	Bv,	// in: denominator B[nB-1] ... B[0]
+	int				nB)	// in: actual deg(B)
+// -----------------------------------------------------------------------------
+{
+	for (int iq=nA-nB; iq>=0; iq--) {
+		uint8_t qv = Av[iq + nB];
+		if (qv != GF_0)
+			gfRegionMulAdd(Av + iq, Bv, gfV2E[qv], nB);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Compute table for gfPolEvalSeqT():
+//   T[ia * GF_SEQ_ROW(nY) + iy] = (x * z^(nY-iy))^ia   (vector repr.)
+// Row ia is the sequence computed by the inner loop of gfPolEvalSeq() for A[ia]
+// = 1.  The padding at the end of each row is 0.
+// -----------------------------------------------------------------------------
+void gfPolEvalSeqTab(
+	uint8_t*	T,	// out: table
+	int			nA,	// max. deg(A)
+	int			nY,	// number of locations - 1
+	gfExp		x)	// 1st location
+// -----------------------------------------------------------------------------
+{
+	const int w = GF_SEQ_ROW(nY);
+	for (int i=(nA+1)*w-1; i>=0; i--)
+		T[i] = GF_0;
+	for (int iy=nY; iy>=0; iy--)				// x^0 = 1
+		T[iy] = gfE2V[GF_1];
+	gfExp xi = x;								// start with xi = x^1
+	for (int ia=1; ia<=nA; ia++) {
+		uint8_t* Ti = T + ia * w;
+		gfExp zi = GF__Z(ia);					// zi = z^ia (for any ia)
+		gfExp v = xi;
+		for (int iy=nY; iy>=0; iy--) {
+			Ti[iy] = gfE2V[v];
+			v = gfMul11(v, zi);					// v = x^ia * (z^ia)^l
+		}
+		xi = gfMul11(xi, x);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Syndrome engine: Y += sum(A[ia] * T[ia]), ia=0..nA, for A in exponent
+// (vec = 0) or vector representation (vec = 1).
+// Unlike a loop of gfRegionMulAdd() calls, each block of 32 (AVX2) or 16
+// (SSSE3) results stays in a register over all coeffs of A, so there are
+// no loads and stores of Y, no call overhead and no scalar tail per coeff: the
+// table rows are padded to whole registers.  Only the nibble tables of A[ia]
+// are loaded per coeff.  A[ia] = 0 needs no test, gfNib[GF_0] is all 0.
+// (Horner's scheme in lanes would need a different multiplier per lane, which
+// PSHUFB can't do.)
+// Return 0 if all Y are 0, else 1.
+// -----------------------------------------------------------------------------
+static inline int gfSeqT(
+	const uint8_t*	A,	// polynomial, exp. or vector repr.
+	int				vec,// A is in vector repr.
+	int				nA,	// max. deg(A)
+	uint8_t*		Y,	// in/out: results, padded to GF_SEQ_ROW(nY)
+	int				nY,	// number of locations - 1
+	const uint8_t*	T)	// table from gfPolEvalSeqTab(), row of A[0]
+// -----------------------------------------------------------------------------
+{
+	const int w = GF_SEQ_ROW(nY);
+  #if defined(__AVX2__)
+	__m256i m4 = _mm256_set1_epi8(0x0f);
+	__m256i nz = _mm256_setzero_si256();
+	for (int iy=0; iy<w; iy+=32) {
+		const uint8_t* Ti = T + iy;
+		__m256i y = _mm256_loadu_si256((const __m256i*) (Y + iy));
+		for (int ia=0; ia<=nA; ia++, Ti+=w) {
+			const uint8_t* N = gfNib[vec ? gfV2E[A[ia]] : A[ia]];
+			__m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) N));
+			__m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) (N + 16)));
+			__m256i v  = _mm256_loadu_si256((const __m256i*) Ti);
+			__m256i lo = _mm256_and_si256(v, m4);
+			__m256i hi = _mm256_and_si256(_mm256_srli_epi64(v, 4), m4);
+			y = _mm256_xor_si256(y, _mm256_xor_si256(_mm256_shuffle_epi8(tlo, lo),
+													 _mm256_shuffle_epi8(thi, hi)));
+		}
+		_mm256_storeu_si256((__m256i*) (Y + iy), y);
+		nz = _mm256_or_si256(nz, y);
+	}
+	return ! _mm256_testz_si256(nz, nz);
+  #elif defined(__SSSE3__)
+	__m128i m4 = _mm_set1_epi8(0x0f);
+	__m128i nz = _mm_setzero_si128();
+	for (int iy=0; iy<w; iy+=16) {
+		const uint8_t* Ti = T + iy;
+		__m128i y = _mm_loadu_si128((const __m128i*) (Y + iy));
+		for (int ia=0; ia<=nA; ia++, Ti+=w) {
+			const uint8_t* N = gfNib[vec ? gfV2E[A[ia]] : A[ia]];
+			__m128i tlo = _mm_loadu_si128((const __m128i*) N);
+			__m128i thi = _mm_loadu_si128((const __m128i*) (N + 16));
+			__m128i v  = _mm_loadu_si128((const __m128i*) Ti);
+			__m128i lo = _mm_and_si128(v, m4);
+			__m128i hi = _mm_and_si128(_mm_srli_epi64(v, 4), m4);
+			y = _mm_xor_si128(y, _mm_xor_si128(_mm_shuffle_epi8(tlo, lo),
+											   _mm_shuffle_epi8(thi, hi)));
+		}
+		_mm_storeu_si128((__m128i*) (Y + iy), y);
+		nz = _mm_or_si128(nz, y);
+	}
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(nz, _mm_setzero_si128())) != 0xffff;
+  #else
+	for (int ia=0; ia<=nA; ia++, T+=w)
+		gfRegionMulAdd(Y, T, vec ? gfV2E[A[ia]] : A[ia], nY + 1);
+	uint8_t nz = 0;
+	for (int iy=nY; iy>=0; iy--)
+		nz |= Y[iy];
+	return nz != 0;
+  #endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Evaluate polynomial A(X) at nY+1 "sequential" locations X = x * z^i, i=0..nY
+// using a table from gfPolEvalSeqTab():
+//   Yv = sum(A[ia] * T[ia]), ia=0..nA
+// -----------------------------------------------------------------------------
+int gfPolEvalSeqT(
+	gfExp*			A,	// polynomial
+	int				nA,	// max. deg(A), as passed to gfPolEvalSeqTab()
+	gfVec*			Yv,	// result array (vector repr.) with Yv[nY] = A(x) ... Yv[0] = A(x * z^nY)
+	int				nY,	// number of locations - 1, as passed to gfPolEvalSeqTab()
+	const uint8_t*	T)	// table from gfPolEvalSeqTab()
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- polEvalSeqT\n");
+	PRINTPOL("seq: A", A, nA);
+	uint8_t Y[GF_SEQ_ROW(nY)];
+	for (int iy=GF_SEQ_ROW(nY)-1; iy>=0; iy--)
+		Y[iy] = GF_0;
+  #if defined(GF_INT_SYMBOLS)
+	// gfSeqT() needs one byte per coeff:
+	uint8_t A8[nA + 1];
+	for (int ia=nA; ia>=0; ia--)
+		A8[ia] = A[ia];
+	int nz = gfSeqT(A8, 0, nA, Y, nY, T);
+  #else
+	int nz = gfSeqT(A, 0, nA, Y, nY, T);
+  #endif
+	for (int iy=nY; iy>=0; iy--)
+		Yv[iy] = Y[iy];
+	PRINTPOL("seq: Yv", Yv, nY);
+	return nz;
+}
+
+
+// -----------------------------------------------------------------------------
+// Return bit l set where A(z^(nY-iy-l)) = 0, l=0..31 (lanes up to the padding)
+// -----------------------------------------------------------------------------
+static inline uint32_t gfZeroLanes(
+	gfExp*			A,	// polynomial
+	int				nA,	// max. deg(A)
+	const uint8_t*	T,	// table from gfPolEvalSeqTab(), column iy of row 0
+	int				w)	// row length
+// -----------------------------------------------------------------------------
+{
+  #if defined(__AVX2__)
+	__m256i m4 = _mm256_set1_epi8(0x0f);
+	__m256i y = _mm256_setzero_si256();
+	for (int ia=0; ia<=nA; ia++, T+=w) {
+		const uint8_t* N = gfNib[A[ia]];
+		__m256i tlo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) N));
+		__m256i thi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) (N + 16)));
+		__m256i v  = _mm256_loadu_si256((const __m256i*) T);
+		__m256i lo = _mm256_and_si256(v, m4);
+		__m256i hi = _mm256_and_si256(_mm256_srli_epi64(v, 4), m4);
+		y = _mm256_xor_si256(y, _mm256_xor_si256(_mm256_shuffle_epi8(tlo, lo),
+												 _mm256_shuffle_epi8(thi, hi)));
+	}
+	return _mm256_movemask_epi8(_mm256_cmpeq_epi8(y, _mm256_setzero_si256()));
+  #elif defined(__SSSE3__)
+	__m128i m4 = _mm_set1_epi8(0x0f);
+	__m128i y0 = _mm_setzero_si128();
+	__m128i y1 = _mm_setzero_si128();
+	for (int ia=0; ia<=nA; ia++, T+=w) {
+		const uint8_t* N = gfNib[A[ia]];
+		__m128i tlo = _mm_loadu_si128((const __m128i*) N);
+		__m128i thi = _mm_loadu_si128((const __m128i*) (N + 16));
+		__m128i v0 = _mm_loadu_si128((const __m128i*) T);
+		__m128i v1 = _mm_loadu_si128((const __m128i*) (T + 16));
+		y0 = _mm_xor_si128(y0, _mm_xor_si128(
+				_mm_shuffle_epi8(tlo, _mm_and_si128(v0, m4)),
+				_mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(v0, 4), m4))));
+		y1 = _mm_xor_si128(y1, _mm_xor_si128(
+				_mm_shuffle_epi8(tlo, _mm_and_si128(v1, m4)),
+				_mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(v1, 4), m4))));
+	}
+	__m128i z = _mm_setzero_si128();
+	return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(y0, z))
+		 | (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(y1, z)) << 16;
+  #else
+	uint8_t y[32] = {0};
+	for (int ia=0; ia<=nA; ia++, T+=w) {
+		const uint8_t* N = gfNib[A[ia]];
+		for (int l=0; l<32; l++)
+			y[l] ^= N[T[l] & 15] ^ N[16 + (T[l] >> 4)];
+	}
+	uint32_t m = 0;
+	for (int l=0; l<32; l++)
+		m |= (uint32_t) (y[l] == 0) << l;
+	return m;
+  #endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Chien search with table, 32 locations per step.  Columns iy < nY-nZ are
+// skipped, the search starts at their (aligned) block.
+// -----------------------------------------------------------------------------
+int gfPolRootsT(
+	gfExp*			A,	// polynomial
+	int				nA,	// max. deg(A)
+	int				nY,	// highest location of the table, as passed to gfPolEvalSeqTab()
+	int				nZ,	// highest location z^nZ to search, nZ <= nY
+	gfExp*			R,	// out: roots, max. nR
+	int				nR,	// in: max. number of roots to find
+	const uint8_t*	T)	// table from gfPolEvalSeqTab()
+// -----------------------------------------------------------------------------
+{
+	const int w = GF_SEQ_ROW(nY);
+	const int iy0 = nY - nZ;				// column of z^nZ
+	int nX = 0;
+	for (int iy=iy0&~31; iy<=nY; iy+=32) {
+		uint32_t m = gfZeroLanes(A, nA, T + iy, w);
+		if (nY - iy < 31)
+			m &= (1u << (nY - iy + 1)) - 1;		// padding is no root
+		if (iy < iy0)
+			m &= ~0u << (iy0 - iy);				// beyond the shortened codeword
+		for (; m; m&=m-1) {
+			R[nX++] = GF_Z(nY - iy - __builtin_ctz(m));
+			if (nX == nR)
+				return nX;
+		}
+	}
+	return nX;
+}
+
+
+// -----------------------------------------------------------------------------
+// Same for A in vector representation, adding to Y
+// -----------------------------------------------------------------------------
+int gfPolEvalSeqTV(
+	const uint8_t*	Av,	// polynomial, vector repr.
+	int				nA,	// max. deg(A)
+	uint8_t*		Y,	// in/out: results, GF_SEQ_ROW(nY) bytes
+	int				nY,	// number of locations - 1, as passed to gfPolEvalSeqTab()
+	const uint8_t*	T)	// table from gfPolEvalSeqTab(), row of Av[0]
+// -----------------------------------------------------------------------------
+{
+	return gfSeqT(Av, 1, nA, Y, nY, T);
+}
+
+
+#if defined(__GFNI__) && defined(__AVX2__)
+// -----------------------------------------------------------------------------
+// Matrix of the multiplication by c (vector repr.) for GF2P8AFFINEQB: byte
+// 7-r holds the bits of v that make bit r of c * v
+// -----------------------------------------------------------------------------
+static uint64_t gfAffineMat(gfVec c)
+{
+	uint64_t M = 0;
+	for (int b=0; b<BITS_PER_SYMBOL; b++) {
+		gfVec col = gfMulV(c, (gfVec) (1 << b));	// c * (basis vector b)
+		for (int r=0; r<BITS_PER_SYMBOL; r++)
+			M |= (uint64_t) ((col >> r) & 1) << (8 * (7 - r) + b);
+	}
+	return M;
+}
+
+
+// -----------------------------------------------------------------------------
+// Transpose 16 x 16 bytes: byte j of X[i] <-> byte i of X[j].  Each round
+// interleaves rows i and i+8, four rounds make the transpose.
+// -----------------------------------------------------------------------------
+static inline void gfTranspose16(__m128i* X)
+{
+	for (int round=0; round<4; round++) {
+		__m128i Y[16];
+		for (int i=0; i<8; i++) {
+			Y[2 * i]     = _mm_unpacklo_epi8(X[i], X[i + 8]);
+			Y[2 * i + 1] = _mm_unpackhi_epi8(X[i], X[i + 8]);
+		}
+		for (int i=0; i<16; i++)
+			X[i] = Y[i];
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Zero test of nl <= 32 polynomials, polynomial l in byte lane l: the coeffs
+// are transposed into V[ia] (16 x 16 bytes at a time), then Horner's scheme
+// acc = acc * X + V[ia] runs for 8 locations per pass over V, whose matrices
+// stay in registers.
+// Return bit l set for polynomial l != 0 at some location.
+// -----------------------------------------------------------------------------
+static uint32_t gfCheckLanes(
+	const uint8_t*	Av,		// 1st polynomial
+	int				stride,	// distance between polynomials
+	int				nl,		// number of polynomials
+	int				nA,		// max. deg(Av)
+	int				nM,		// number of matrices, a multiple of 8
+	const __m256i*	M)		// multiplication by the locations
+// -----------------------------------------------------------------------------
+{
+	__m256i V[nA + 1];
+	uint8_t* Vb = (uint8_t*) V;
+	for (int h=0; h<2; h++) {					// lanes 16h ... 16h+15
+		const int nh = MIN(16, nl - 16 * h);
+		if (nh <= 0) {
+			for (int ia=0; ia<=nA; ia++)
+				_mm_storeu_si128((__m128i*) (Vb + 32 * ia + 16 * h), _mm_setzero_si128());
+			continue;
+		}
+		const uint8_t* P = Av + (ptrdiff_t) 16 * h * stride;
+		int ia = 0;
+		for (; ia+16<=nA+1; ia+=16) {
+			__m128i X[16];
+			for (int l=0; l<16; l++)
+				X[l] = (l < nh) ? _mm_loadu_si128((const __m128i*) (P + (ptrdiff_t) l * stride + ia))
+								: _mm_setzero_si128();
+			gfTranspose16(X);
+			for (int i=0; i<16; i++)
+				_mm_storeu_si128((__m128i*) (Vb + 32 * (ia + i) + 16 * h), X[i]);
+		}
+		for (; ia<=nA; ia++)
+			for (int l=0; l<16; l++)
+				Vb[32 * ia + 16 * h + l] = (l < nh) ? P[(ptrdiff_t) l * stride + ia] : 0;
+	}
+
+	__m256i nz = _mm256_setzero_si256();
+	for (int j=0; j<nM; j+=8) {
+		__m256i acc[8];
+		for (int u=0; u<8; u++)
+			acc[u] = _mm256_setzero_si256();
+		for (int ia=nA; ia>=0; ia--) {
+			__m256i v = _mm256_loadu_si256(V + ia);
+			for (int u=0; u<8; u++)
+				acc[u] = _mm256_xor_si256(_mm256_gf2p8affine_epi64_epi8(acc[u], M[j + u], 0), v);
+		}
+		for (int u=0; u<8; u++)
+			nz = _mm256_or_si256(nz, acc[u]);
+	}
+	return ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(nz, _mm256_setzero_si256()));
+}
+#endif
+
+
+// -----------------------------------------------------------------------------
+// Zero test of cnt polynomials at the locations of a table from
+// gfPolEvalSeqTab().  Row 1 of the table holds the locations themselves.
+// -----------------------------------------------------------------------------
+int gfPolCheckSeqV(
+	const uint8_t*	Av,		// 1st polynomial, vector repr.
+	int				stride,	// distance between polynomials
+	int				cnt,	// number of polynomials
+	int				nA,		// max. deg(Av), as passed to gfPolEvalSeqTab()
+	int				nY,		// number of locations - 1, as passed to gfPolEvalSeqTab()
+	const uint8_t*	T,		// table from gfPolEvalSeqTab()
+	uint8_t*		nz)		// out: cnt flags; may be NULL
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- polCheckSeqV\n");
+	int nDirty = 0;
+  #if defined(__GFNI__) && defined(__AVX2__)
+	const int nM = (nY + 8) & ~7;				// nY+1 rounded up
+	__m256i M[nM];
+	for (int iy=0; iy<nM; iy++)					// padding: last location again
+		M[iy] = _mm256_set1_epi64x((long long) gfAffineMat(T[GF_SEQ_ROW(nY) + MIN(iy, nY)]));
+	for (int c0=0; c0<cnt; c0+=32) {
+		const int nl = MIN(32, cnt - c0);
+		uint32_t m = gfCheckLanes(Av + (ptrdiff_t) c0 * stride, stride, nl, nA, nM, M);
+		if (nl < 32)
+			m &= (1u << nl) - 1;
+		nDirty += __builtin_popcount(m);
+		if (nz)
+			for (int l=0; l<nl; l++)
+				nz[c0 + l] = (m >> l) & 1;
+	}
+  #else
+	uint8_t Y[GF_SEQ_ROW(nY)];
+	for (int c=0; c<cnt; c++) {
+		for (int iy=GF_SEQ_ROW(nY)-1; iy>=0; iy--)
+			Y[iy] = GF_0;
+		int d = gfSeqT(Av + (ptrdiff_t) c * stride, 1, nA, Y, nY, T);
+		nDirty += d;
+		if (nz)
+			nz[c] = d;
+	}
+  #endif
+	return nDirty;
+}
+#endif	// GF_N <= 256
+
+
+#if (GF_N > 256)
+// =============================================================================
+// carry-less multiplication:
+// =============================================================================
+
+#if defined(__PCLMUL__)
+  #include <wmmintrin.h>
+const int gfClmul = 1;
+#else
+const int gfClmul = 0;
+#endif
+
+#define GF_CL_CHUNK	256		// window of gfPolRemC(), in coefficients
+
+
+// -----------------------------------------------------------------------------
+// carry-less product a * b, deg(a) + deg(b) < 64
+// -----------------------------------------------------------------------------
+static inline uint64_t gfClMul1(uint64_t a, uint64_t b)
+{
+  #if defined(__PCLMUL__)
+	__m128i p = _mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0x00);
+	return _mm_cvtsi128_si64(p);
+  #else
+	return gfClMulSw(a, b);
+  #endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Barrett reduction u % P*, deg(u) < 2n
+// -----------------------------------------------------------------------------
+static inline uint32_t gfClRed(uint64_t u)
+{
+	const int n = BITS_PER_SYMBOL;
+	uint64_t q = gfClMul1(u >> n, gfClK[1]) >> n;	// floor(u / P*)
+	return (u ^ gfClMul1(q, gfClK[0])) & (GF_N - 1);
+}
+
+
+#if defined(__PCLMUL__)
+// -----------------------------------------------------------------------------
+// 4 words of a times c (in the low word of c): both products of a 64-bit
+// lane fit into it, since they have less than 32 bits
+// -----------------------------------------------------------------------------
+static inline __m128i gfClMulS4(__m128i a, __m128i c)
+{
+	__m128i lo = _mm_clmulepi64_si128(a, c, 0x00);
+	__m128i hi = _mm_clmulepi64_si128(a, c, 0x01);
+	return _mm_unpacklo_epi64(lo, hi);
+}
+
+
+// -----------------------------------------------------------------------------
+// 4 words of a times 4 words of b
+// -----------------------------------------------------------------------------
+static inline __m128i gfClMul4(__m128i a, __m128i b)
+{
+	const __m128i m = _mm_set1_epi64x(0xffffffff);
+	__m128i ae = _mm_and_si128(a, m), be = _mm_and_si128(b, m);
+	__m128i ao = _mm_srli_epi64(a, 32), bo = _mm_srli_epi64(b, 32);
+	__m128i e = _mm_unpacklo_epi64(_mm_clmulepi64_si128(ae, be, 0x00),
+								   _mm_clmulepi64_si128(ae, be, 0x11));
+	__m128i o = _mm_unpacklo_epi64(_mm_clmulepi64_si128(ao, bo, 0x00),
+								   _mm_clmulepi64_si128(ao, bo, 0x11));
+	return _mm_or_si128(e, _mm_slli_epi64(o, 32));
+}
+
+
+// -----------------------------------------------------------------------------
+// gfClRed() of 4 words
+// -----------------------------------------------------------------------------
+static inline __m128i gfClRed4(__m128i u)
+{
+	const int n = BITS_PER_SYMBOL;
+	const __m128i P = _mm_cvtsi32_si128(gfClK[0]);
+	const __m128i mu = _mm_cvtsi32_si128(gfClK[1]);
+	__m128i q = _mm_srli_epi32(gfClMulS4(_mm_srli_epi32(u, n), mu), n);
+	return _mm_and_si128(_mm_xor_si128(u, gfClMulS4(q, P)),
+						 _mm_set1_epi32(GF_N - 1));
+}
+#endif
+
+
+// -----------------------------------------------------------------------------
+uint32_t gfClPrep(gfVec c)
+// -----------------------------------------------------------------------------
+{
+	return gfClRed(gfClMul1(c, gfClK[2]));
+}
+
+
+// -----------------------------------------------------------------------------
+gfVec gfMulC(gfVec a, gfVec b)
+// -----------------------------------------------------------------------------
+{
+	return gfClRed(gfClMul1(a, gfClPrep(b)));
+}
+
+
+// -----------------------------------------------------------------------------
+// W ^= q * Bc (unreduced), len a multiple of 4
+// -----------------------------------------------------------------------------
+static void gfClMulAdd(
+	uint32_t*		W,
+	const uint32_t*	Bc,
+	uint32_t		q,
+	int				len)
+{
+  #if defined(__PCLMUL__)
+	__m128i c = _mm_cvtsi32_si128(q);
+	for (int i=0; i<len; i+=4) {
+		__m128i b = _mm_loadu_si128((const __m128i*) (Bc + i));
+		__m128i w = _mm_loadu_si128((const __m128i*) (W + i));
+		_mm_storeu_si128((__m128i*) (W + i), _mm_xor_si128(w, gfClMulS4(b, c)));
+	}
+  #else
+	for (int i=0; i<len; i++)
+		W[i] ^= gfClMul1(Bc[i], q);
+  #endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Synthetic division of the dividend D = X^nB * A in a window of GF_CL_CHUNK
+// quotient coefficients, sliding down from the top, so the stack holds only
+// nB + GF_CL_CHUNK words.  The quotient coefficient is reduced, the rest of
+// the window accumulates unreduced products.
+// -----------------------------------------------------------------------------
+void gfPolRemC(
+	const gfSym*	Av,	// in: A[nA] ... A[0]
+	int				nA,	// in: max. deg(A)
+	const uint32_t*	Bc,	// in: prepared denominator B[nB-1] ... B[0]
+	int				nB,	// in: actual deg(B)
+	gfSym*			R)	// out: remainder R[nB-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	const int ch = GF_CL_CHUNK;
+	const int len = GF_CL_ROW(nB - 1);
+	uint32_t W[nB + ch + 3];			// W[t] = D[lo + t], + 3: padding of Bc
+	int lo = nA + 1 - ch;
+	for (int t=0; t<nB+ch+3; t++) {
+		int d = lo + t;
+		W[t] = ((d >= nB) && (d <= nA + nB)) ? Av[d - nB] : 0;
+	}
+	for (;;) {
+		for (int t=nB+ch-1; (t >= nB) && (lo + t >= nB); t--)
+			gfClMulAdd(W + t - nB, Bc, gfClRed(W[t]), len);
+		if (lo <= 0)
+			break;
+		for (int t=nB-1; t>=0; t--)		// slide down
+			W[ch + t] = W[t];
+		lo -= ch;
+		for (int t=0; t<ch; t++) {
+			int d = lo + t;
+			W[t] = (d >= nB) ? Av[d - nB] : 0;
+		}
+	}
+	for (int i=0; i<nB; i++)
+		R[i] = gfClRed(W[i - lo]);
+}
+
+
+// -----------------------------------------------------------------------------
+void gfPolEvalTabC(
+	uint32_t*	T,	// out: table
+	int			nY,	// number of locations - 1
+	gfExp		x)	// 1st location
+// -----------------------------------------------------------------------------
+{
+	const int w = GF_CL_ROW(nY);
+	for (int iy=0; iy<w; iy++) {
+		gfExp xi = (iy <= nY) ? gfMul(x, GF_Z(nY - iy)) : GF_0;
+		gfExp p = (iy <= nY) ? GF_1 : GF_0;				// xi^t
+		for (int t=0; t<=GF_CL_BLOCK; t++) {
+			T[t * w + iy] = gfClPrep(gfE2V[p]);
+			p = gfMul(p, xi);
+		}
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Per block of coefficients A[i] ... A[i-B+1] (B = GF_CL_BLOCK):
+//   Y = Y * x^B + sum(A[i-t] * x^(B-1-t))
+// with a single reduction of the sum.  The leading (nA+1) % B coefficients
+// are done one by one.
+// -----------------------------------------------------------------------------
+int gfPolEvalC(
+	const gfSym*	Av,	// in: polynomial (piece) A[nA] ... A[0]
+	int				nA,	// in: max. deg(A)
+	uint32_t*		Y,	// in/out: results (vector repr.), GF_CL_ROW(nY) words, padding 0
+	int				nY,	// in: number of locations - 1
+	const uint32_t*	T)	// in: table from gfPolEvalTabC()
+// -----------------------------------------------------------------------------
+{
+	const int B = GF_CL_BLOCK;
+	const int w = GF_CL_ROW(nY);
+	int i = nA;
+  #if defined(__PCLMUL__)
+	for (; (i + 1) % B; i--) {
+		__m128i c = _mm_cvtsi32_si128(Av[i]);
+		for (int j=0; j<w; j+=4) {
+			__m128i y = _mm_loadu_si128((const __m128i*) (Y + j));
+			__m128i u = gfClMul4(y, _mm_loadu_si128((const __m128i*) (T + w + j)));
+			u = _mm_xor_si128(u, gfClMulS4(_mm_loadu_si128((const __m128i*) (T + j)), c));
+			_mm_storeu_si128((__m128i*) (Y + j), gfClRed4(u));
+		}
+	}
+	for (; i>=0; i-=B) {
+		for (int j=0; j<w; j+=4) {
+			__m128i y = _mm_loadu_si128((const __m128i*) (Y + j));
+			__m128i u = gfClMul4(y, _mm_loadu_si128((const __m128i*) (T + B * w + j)));
+			for (int t=0; t<B; t++) {
+				__m128i x = _mm_loadu_si128((const __m128i*) (T + (B - 1 - t) * w + j));
+				u = _mm_xor_si128(u, gfClMulS4(x, _mm_cvtsi32_si128(Av[i - t])));
+			}
+			_mm_storeu_si128((__m128i*) (Y + j), gfClRed4(u));
+		}
+	}
+  #else
+	for (; (i + 1) % B; i--)
+		for (int j=0; j<w; j++)
+			Y[j] = gfClRed(gfClMul1(Y[j], T[w + j]) ^ gfClMul1(Av[i], T[j]));
+	for (; i>=0; i-=B) {
+		for (int j=0; j<w; j++) {
+			uint64_t u = gfClMul1(Y[j], T[B * w + j]);
+			for (int t=0; t<B; t++)
+				u ^= gfClMul1(Av[i - t], T[(B - 1 - t) * w + j]);
+			Y[j] = gfClRed(u);
+		}
+	}
+  #endif
+	uint32_t nz = 0;
+	for (int j=0; j<w; j++)
+		nz |= Y[j];
+	return nz != 0;
+}
+#endif	// GF_N > 256
@@ -13,6 +13,7 @@
 #ifndef _GF_H
 #define _GF_H
 
+#include <stdint.h>
 #include <ecc_cfg.h>	// needed for GF_N = 2^n (field size)
 
 #ifndef GF_N
@@ -48,13 +49,67 @@
 //	z^(-(m-1)) = z^1	2					GF__Z(-(m-1))
 
 
-typedef int   gfExp;	// exponent representation
+// Both use the narrowest type for GF_N, which keeps the tables below and all
+// polynomial buffers small (GF_N = 65536: 2 x 128 KB instead of 2 x 256 KB).
+// Define GF_INT_SYMBOLS to use int instead (for comparison, see bench_gf).
+#if defined(GF_INT_SYMBOLS)
+typedef int      gfExp;	// exponent representation
+#elif (GF_N <= 256)
+typedef uint8_t  gfExp;
+#else
+typedef uint16_t gfExp;
+#endif
 typedef gfExp gfVec;	// vector representation
 
+// Symbols as stored in memory or on disk, in vector representation, using the
+// narrowest type (byte buffer APIs), regardless of GF_INT_SYMBOLS:
+#if (GF_N <= 256)
+typedef uint8_t  gfSym;
+#else
+typedef uint16_t gfSym;
+#endif
+
+// Lookup tables are generated at build time (gf_gen.c -> gf_tab.h), so they
+// are const, in read-only memory shared by all processes, and need no
+// initialization.  The generator itself is built with GF_GEN and computes
+// them in gfInit().
+#ifdef GF_GEN
+  #define GF_TAB
+#else
+  #define GF_TAB const
+#endif
+
 // lookup tables to convert between both representations:
-extern gfVec gfE2V[GF_N];	// z^i -> vector
-extern gfExp gfV2E[GF_N];	// vector -> z^i
-// extern gfExp zechLog[GF_N];	// was used by gfAdd() but turned out to be slower
+extern GF_TAB gfVec gfE2V[GF_N];	// z^i -> vector
+extern GF_TAB gfExp gfV2E[GF_N];	// vector -> z^i
+
+
+// Arithmetic back-end of the basic operations on gfExp below, chosen at build
+// time ("make GF_ARITH=ZECH" etc.).  Which one is fastest depends on the CPU
+// and the field size, see "make bench_arith" in test/.
+#define GF_ARITH_LOG	0	// exp/log tables only; gfAdd() needs 3 lookups
+#define GF_ARITH_ZECH	1	// gfAdd() with Zech logarithms: 1 lookup, 3 branches
+#define GF_ARITH_TAB	2	// gfMul() from a full product table (GF(2^8): 64 KB)
+#ifndef GF_ARITH
+  #define GF_ARITH GF_ARITH_LOG
+#endif
+// the generator uses GF_ARITH_LOG to compute the tables:
+#if defined(GF_GEN)
+  #define GF_ARITH_OPS GF_ARITH_LOG
+#else
+  #define GF_ARITH_OPS GF_ARITH
+#endif
+
+#if (GF_ARITH == GF_ARITH_ZECH)
+// zechLog[a] = 1 + a  (exp. repr.), i.e. log(1 + z^i) for a = z^i
+extern GF_TAB gfExp zechLog[GF_N];
+#elif (GF_ARITH == GF_ARITH_TAB)
+  #if (GF_N > 256)
+	#error "GF_ARITH_TAB needs GF_N <= 256"
+  #endif
+// gfMulTab[a][b] = a * b  (exp. repr.)
+extern GF_TAB gfExp gfMulTab[GF_N][GF_N];
+#endif
 
 
 // -----------------------------------------------------------------------------
@@ -126,10 +181,15 @@ inline gfExp gfMul11(gfExp a, gfExp b)
 	if (b == GF_0)
 		printf("ERROR: gfMul11: b=0 !!\n");
   #endif
-	gfExp r = a + b - 1;
-	if (r >= GF_N)
-		r -= (GF_N - 1);
+  #if (GF_ARITH_OPS == GF_ARITH_TAB)
+	return gfMulTab[a][b];
+  #else
+	int r = a + b - 1;		// int: may exceed gfExp
+	// branch-free version of: if (r >= GF_N) r -= (GF_N - 1);
+	// (the compiler doesn't always use a cmov, and the branch is random)
+	r -= (GF_N - 1) & -(r >= GF_N);
 	return r;
+  #endif
 }
 
 
@@ -138,9 +198,13 @@ inline gfExp gfMul11(gfExp a, gfExp b)
 inline gfExp gfMul01(gfExp a, gfExp b)
 // -----------------------------------------------------------------------------
 {
+  #if (GF_ARITH_OPS == GF_ARITH_TAB)
+	return gfMulTab[a][b];
+  #else
 	if (a == GF_0)
 		return GF_0;
 	return gfMul11(a, b);
+  #endif
 }
 
 
@@ -149,9 +213,13 @@ inline gfExp gfMul01(gfExp a, gfExp b)
 inline gfExp gfMul(gfExp a, gfExp b)
 // -----------------------------------------------------------------------------
 {
+  #if (GF_ARITH_OPS == GF_ARITH_TAB)
+	return gfMulTab[a][b];	// no 0-checks
+  #else
 	if (b == GF_0)
 		return GF_0;
 	return gfMul01(a, b);
+  #endif
 }
 
 
@@ -167,7 +235,7 @@ inline gfExp gfDiv1(gfExp a, gfExp b)
 	if (b == GF_0)
 		printf("ERROR: gfDiv1: b=0 (division by zero) !!\n");
   #endif
-	gfExp r = a - b + 1;
+	int r = a - b + 1;		// int: may be negative
 	if (r <= 0)
 		r += (GF_N - 1);
 	return r;
@@ -207,31 +275,57 @@ inline gfExp gfDiv(gfExp a, gfExp b)
 inline gfExp gfAdd(gfExp a, gfExp b)
 // -----------------------------------------------------------------------------
 {
+  #if (GF_ARITH_OPS == GF_ARITH_ZECH)
+	// Zech logarithm: only one table lookup (instead of 3), but 0-checks:
+	if (a == GF_0)
+		return b;
+	if (b == GF_0)
+		return a;
+	if (a == b)
+		return GF_0;
+	// z^i + z^j = z^i * (1 + z^(j-i))
+	// <=> log(z^i + z^j) = i + log(1 + z^(j-i))
+	//                          `-zechLog[j-i]-'
+	gfExp b_a = gfDiv1(b, a);	// can't be z^0 (a==b already catched)
+	return gfMul11(a, zechLog[b_a]);	// zechLog[b_a] can't be GF_0
+  #else
 	return gfV2E[gfE2V[a] ^ gfE2V[b]];
-// Smarter but slower :( using the Zech-logarithm.  It requires only one table
-// lookup (instead of 3) but apparently more expensive 0-checks.
-// 	if (a == GF_0)
-// 		return b;
-// 	if (b == GF_0)
-// 		return a;
-// 	if (a == b)
-// 		return GF_0;
-// 	// otherwise, use the Zech-logarithm (from table):
-// 	// z^i + z^j = z^i * (1 + z^(j-i))
-// 	// <=> log(z^i + z^j) = i + log(1 + z^(j-i))
-// 	//                          `-zechLog[j-i]-'
-// 	gfExp b_a = gfDiv(b, a);	// can't be z^0 (a==b already catched)
-// 	gfExp zl = zechLog[b_a];	// => can't be GF_0
-// 	gfExp r = a + zl;
-// 	if (r >= GF_N)
-// 		r -= (GF_N - 1);
-// 	return r;
+  #endif
 }
 #define gfSub gfAdd	// true for char(GF) == 2
 
 
 // -----------------------------------------------------------------------------
-// initialize LUTs gfExp <-> gfVec
+// Same operations in vector representation (adding is just XOR), multiplying
+// via log/antilog tables.  For code that keeps symbols as stored.
+// -----------------------------------------------------------------------------
+
+// a * b
+// -----------------------------------------------------------------------------
+inline gfVec gfMulV(gfVec a, gfVec b)
+// -----------------------------------------------------------------------------
+{
+	if ((a == GF_0) || (b == GF_0))
+		return GF_0;
+	return gfE2V[gfMul11(gfV2E[a], gfV2E[b])];
+}
+
+
+// a / b; b!=0
+// -----------------------------------------------------------------------------
+inline gfVec gfDivV(gfVec a, gfVec b)
+// -----------------------------------------------------------------------------
+{
+	if (a == GF_0)
+		return GF_0;
+	return gfE2V[gfDiv1(gfV2E[a], gfV2E[b])];
+}
+#define gfAddV(a, b) ((a) ^ (b))
+
+
+// -----------------------------------------------------------------------------
+// initialize LUTs gfExp <-> gfVec (only once; may be called repeatedly).
+// Nothing to do, unless built with GF_GEN (see above).
 // -----------------------------------------------------------------------------
 int gfInit();
 
@@ -347,8 +441,9 @@ void gfPolEvalSeq(
 //   P * N' = Q * A' = lcm(N', A')
 // and
 //   gcd(P, Q) = 1
+// Return the number of iterations (polynomial divisions).
 // -----------------------------------------------------------------------------
-void gfPolEEA(
+int gfPolEEA(
 	gfExp*	N,	// in; only highest coeffs of N'
 	int		nN,	// in: actual deg(N)
 	gfExp*	A,	// in; only highest coeffs of A'
@@ -361,6 +456,27 @@ void gfPolEEA(
 				// out: actual deg(Q)	// FIXME: check if needed/useful
 
 
+// Inversionless Berlekamp-Massey algorithm
+// compute error locator L(X) (times an unknown constant != 0) and error
+// evaluator W(X) = S(X) * L(X) mod X^nL from the syndrome
+//   S(X) = S[nS] * X^nS + ... + S[0],   S[j] = E(z^(j+1))
+// For up to (nS+1)/2 errors at locations Xi:  L(X) = c * prod(1 - Xi * X)
+// With erasures (errors at known locations), L also gets their roots, which
+// allows for e errors and nG erasures as long as 2 * e + nG <= nS+1.
+// Return the number of iterations.
+// -----------------------------------------------------------------------------
+int gfPolBM(
+	gfExp*	S,	// in: syndrome S[0] ... S[nS]
+	int		nS,	// in: max. deg(S) (number of syndromes - 1)
+	gfExp*	G,	// in: erasure locator prod(1 - Xi * X), may be NULL if nG = 0
+	int		nG,	// in: deg(G) = number of erasures, nG <= nS+1
+	gfExp*	L,	// out: error locator, size nS + 2; may be the same as G
+	int		*nL,// out: deg(L) = length of the LFSR (L[nL] may be 0)
+	gfExp*	W,	// out: error evaluator, size nS + 1
+	int		*nW,// out: max. deg(W) = nL - 1
+	gfExp*	M);	// free memory of size: 3 * (nS+2)
+
+
 // Evaluate derivation A'(X) at X=x
 // In GF(2^N), A'(X) computes to:
 //   A(X)  = sum(ai * X^i),     i=0,1,2,3,4,..., deg(A)
@@ -371,4 +487,217 @@ gfExp gfPolEvalDeriv(
 	int		nA,	// max. deg(A)
 	gfExp	x);	// location
 
+
+// Chien search: find the roots of A(X) among the locations z^nY ... z^0 (in
+// this order) and store them in exponent repr. in R.  Stop as soon as nR roots
+// are found.  Return number of roots found.
+// -----------------------------------------------------------------------------
+int gfPolRoots(
+	gfExp*	A,	// polynomial
+	int		nA,	// max. deg(A)
+	int		nY,	// highest location z^nY, nY < GF_N-1
+	gfExp*	R,	// out: roots, max. nR
+	int		nR,	// in: max. number of roots to find
+	gfExp*	M);	// free memory of size: 2 * (nA+1)
+
+
+// =============================================================================
+// region operations, only for GF_N <= 256:
+// Symbols in vector representation, one per byte.  They use SSSE3/AVX2
+// shuffles (if enabled at compile time, see Makefile), 16/32 symbols per
+// instruction.
+// =============================================================================
+#if (GF_N <= 256)
+
+// Split-nibble multiplication tables, for c in exponent representation:
+//   gfNib[c][i]      = c * i        (vector repr., low nibble)
+//   gfNib[c][16 + i] = c * (i << 4) (vector repr., high nibble)
+// so that c * v = gfNib[c][v & 15] ^ gfNib[c][16 + (v >> 4)]
+extern GF_TAB uint8_t gfNib[GF_N][32];
+
+
+// dst ^= c * src  (multiply-accumulate a whole region)
+// -----------------------------------------------------------------------------
+void gfRegionMulAdd(
+	uint8_t*		dst,	// in/out: region, vector repr.
+	const uint8_t*	src,	// in: region, vector repr.
+	gfExp			c,		// in: factor, exponent repr.
+	int				len);	// in: number of symbols
+// -----------------------------------------------------------------------------
+
+
+// In-place synthetic division of A by B, both in vector representation, with
+// deg(B) = nB and B[nB] = 1 (normalized, not passed).  Afterwards
+//   A[nA] ... A[nB]     hold the quotient
+//   A[nB-1] ... A[0]    hold the remainder
+// -----------------------------------------------------------------------------
+void gfPolDiv1V(
+	uint8_t*		Av,	// in: numerator; out: quotient and remainder
+	int				nA,	// in: max. deg(A)
+	const uint8_t*	Bv,	// in: denominator B[nB-1] ... B[0]
+	int				nB);// in: actual deg(B)
+// -----------------------------------------------------------------------------
+
+
+// Row length of the table for gfPolEvalSeqT(): nY+1 bytes rounded up to whole
+// SIMD registers
+#define GF_SEQ_ROW(nY)	(((nY) + 32) & ~31)
+
+
+// Compute table for gfPolEvalSeqT():
+//   T[ia * GF_SEQ_ROW(nY) + iy] = (x * z^(nY-iy))^ia   (vector repr.)
+// for ia=0..nA, iy=0..nY.  T must hold (nA+1) * GF_SEQ_ROW(nY) bytes.
+// -----------------------------------------------------------------------------
+void gfPolEvalSeqTab(
+	uint8_t*	T,	// out: table
+	int			nA,	// max. deg(A)
+	int			nY,	// number of locations - 1
+	gfExp		x);	// 1st location
+// -----------------------------------------------------------------------------
+
+
+// Same as gfPolEvalSeq(), but with a table from gfPolEvalSeqTab(): all nY+1
+// results are accumulated in SIMD registers, one table row per coefficient.
+// Return 0 if all results are 0 (e.g. syndrome of a clean codeword), else 1.
+// -----------------------------------------------------------------------------
+int gfPolEvalSeqT(
+	gfExp*			A,	// polynomial
+	int				nA,	// max. deg(A), as passed to gfPolEvalSeqTab()
+	gfVec*			Yv,	// result array (vector repr.) with Yv[nY] = A(x) ... Yv[0] = A(x * z^nY)
+	int				nY,	// number of locations - 1, as passed to gfPolEvalSeqTab()
+	const uint8_t*	T);	// table from gfPolEvalSeqTab()
+// -----------------------------------------------------------------------------
+
+
+// Same as gfPolRoots() with a table from gfPolEvalSeqTab(T, nA', nY, GF_1),
+// nA' >= nA.  Evaluates A at 32 (AVX2) or 16 (SSSE3) locations at once.
+// Only the locations z^nZ ... z^0 are searched, so a table made for the full
+// codeword serves shortened ones as well, at their cost.
+// -----------------------------------------------------------------------------
+int gfPolRootsT(
+	gfExp*			A,	// polynomial
+	int				nA,	// max. deg(A)
+	int				nY,	// highest location of the table, as passed to gfPolEvalSeqTab()
+	int				nZ,	// highest location z^nZ to search, nZ <= nY
+	gfExp*			R,	// out: roots, max. nR
+	int				nR,	// in: max. number of roots to find
+	const uint8_t*	T);	// table from gfPolEvalSeqTab()
+// -----------------------------------------------------------------------------
+
+
+// Same for A in vector representation (e.g. a codeword in memory), but the
+// results are added to Y.  So A may be passed in pieces: for a piece starting
+// with coeff i0, pass row i0 of the table (T + i0 * GF_SEQ_ROW(nY)).
+// Return 0 if all of Y is 0 afterwards, else 1.
+// -----------------------------------------------------------------------------
+int gfPolEvalSeqTV(
+	const uint8_t*	Av,	// polynomial (piece), vector repr.
+	int				nA,	// max. deg(Av)
+	uint8_t*		Y,	// in/out: results, GF_SEQ_ROW(nY) bytes, padding 0
+	int				nY,	// number of locations - 1, as passed to gfPolEvalSeqTab()
+	const uint8_t*	T);	// table row for Av[0]
+// -----------------------------------------------------------------------------
+
+
+// Zero test of cnt polynomials in vector representation (e.g. codewords in a
+// buffer) at all nY+1 locations of a table from gfPolEvalSeqTab(), nA >= 1
+// rows: nz[c] = 0 if polynomial c is 0 at all of them, else 1.  No results
+// are stored.  With GFNI, 32 polynomials are evaluated at once by Horner's
+// scheme, each byte lane of the registers holding one of them; else one by
+// one as gfPolEvalSeqTV().
+// Return the number of polynomials with nz[c] = 1.
+// -----------------------------------------------------------------------------
+int gfPolCheckSeqV(
+	const uint8_t*	Av,		// 1st polynomial, vector repr.
+	int				stride,	// distance between polynomials
+	int				cnt,	// number of polynomials
+	int				nA,		// max. deg(Av), as passed to gfPolEvalSeqTab()
+	int				nY,		// number of locations - 1, as passed to gfPolEvalSeqTab()
+	const uint8_t*	T,		// table from gfPolEvalSeqTab()
+	uint8_t*		nz);	// out: cnt flags; may be NULL
+// -----------------------------------------------------------------------------
+#endif	// GF_N <= 256
+
+
+// =============================================================================
+// carry-less multiplication, only for GF_N > 256:
+// The tables of the big fields (GF(2^16): 2 x 128 KB) don't fit into the L1
+// cache, so long codewords miss it nearly on every lookup.  These kernels
+// multiply in vector representation without tables, with PCLMULQDQ (if
+// enabled at compile time, see Makefile) and Barrett reduction.
+//
+// Read as polynomial in y, a vector v is v{n-1} * y^(n-1) + ... + v0, with
+// y^(n-2) = 1 (see gfInit()), and the field is GF(2)[y] / P* with the
+// reciprocal polynomial P* of the field polynomial.  The carry-less product
+// of a and b is then the field product times y^(n-2), fixed by prepared
+// constants c' = c * y^-(n-2), see gfClPrep().  The kernels sum up products
+// unreduced (max. 2n-1 bits) and reduce only when needed.
+// =============================================================================
+#if (GF_N > 256)
+
+// Constants of the reduction: P*, floor(y^2n / P*), y^-(n-2) mod P*
+extern GF_TAB uint32_t gfClK[3];
+
+// 1 if built with PCLMULQDQ, else the kernels use a portable carry-less
+// multiplication (for tests only, much slower than the lookup tables)
+extern const int gfClmul;
+
+// Coefficients per block of gfPolEvalC(), and the row length of its table
+#define GF_CL_BLOCK		16
+#define GF_CL_ROW(nY)	(((nY) + 4) & ~3)
+
+
+// Return c prepared for the kernels below: c * y^-(n-2) mod P*
+// -----------------------------------------------------------------------------
+uint32_t gfClPrep(gfVec c);
+// -----------------------------------------------------------------------------
+
+
+// Return a * b, all in vector representation (same as gfMulV())
+// -----------------------------------------------------------------------------
+gfVec gfMulC(gfVec a, gfVec b);
+// -----------------------------------------------------------------------------
+
+
+// Remainder R = (X^nB * A) % B, all in vector representation, with deg(B) =
+// nB and B[nB] = 1 (normalized, not passed), like gfPolDiv1V() but without
+// quotient (which needs no copy of A).  Bc[i] = gfClPrep(B[i]), padded with 0
+// to GF_CL_ROW(nB-1) coefficients.
+// -----------------------------------------------------------------------------
+void gfPolRemC(
+	const gfSym*	Av,	// in: A[nA] ... A[0]
+	int				nA,	// in: max. deg(A)
+	const uint32_t*	Bc,	// in: prepared denominator B[nB-1] ... B[0]
+	int				nB,	// in: actual deg(B)
+	gfSym*			R);	// out: remainder R[nB-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Compute table for gfPolEvalC():
+//   T[t * GF_CL_ROW(nY) + iy] = gfClPrep((x * z^(nY-iy))^t)
+// for t=0..GF_CL_BLOCK, iy=0..nY.  T must hold (GF_CL_BLOCK+1) *
+// GF_CL_ROW(nY) words.
+// -----------------------------------------------------------------------------
+void gfPolEvalTabC(
+	uint32_t*	T,	// out: table
+	int			nY,	// number of locations - 1
+	gfExp		x);	// 1st location
+// -----------------------------------------------------------------------------
+
+
+// Evaluate A (vector repr.) at nY+1 locations by Horner's rule, in blocks of
+// GF_CL_BLOCK coefficients, continuing the evaluation in Y:
+//   Y[iy] = Y[iy] * x_iy^(nA+1) + A(x_iy),  x_iy = x * z^(nY-iy)
+// So A may be passed in pieces, starting with the highest one and Y = 0.
+// Return 0 if all of Y is 0 afterwards, else 1.
+// -----------------------------------------------------------------------------
+int gfPolEvalC(
+	const gfSym*	Av,	// in: polynomial (piece) A[nA] ... A[0]
+	int				nA,	// in: max. deg(A)
+	uint32_t*		Y,	// in/out: results (vector repr.), GF_CL_ROW(nY) words, padding 0
+	int				nY,	// in: number of locations - 1
+	const uint32_t*	T);	// in: table from gfPolEvalTabC()
+// -----------------------------------------------------------------------------
+#endif	// GF_N > 256
+
 #endif	// _GF_H
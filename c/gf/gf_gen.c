@@ -0,0 +1,61 @@
+// -----------------------------------------------------------------------------
+// Build-time generator for the lookup tables of gf.c: prints gf_tab.h with
+// gfE2V, gfV2E (gfNib for GF_N <= 256, the constants of the carry-less
+// multiplication for GF_N > 256, and the tables of the arithmetic back-end,
+// see GF_ARITH) as const initialized arrays.
+// Built with GF_GEN and the same config as gf.o, see Makefile.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "gf.h"
+
+// -----------------------------------------------------------------------------
+static void printTab(const char* decl, const gfExp* T, int len)
+// -----------------------------------------------------------------------------
+{
+	printf("GF_PAGE_ALIGNED const %s = {", decl);
+	for (int i=0; i<len; i++)
+		printf("%s%d,", (i % 16) ? " " : "\n\t", T[i]);
+	printf("\n};\n\n");
+}
+
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	gfInit();
+	printf("// Generated by gf_gen for GF(2^%d) -- do not edit.\n"
+		   "// Included by gf.c only.\n\n", BITS_PER_SYMBOL);
+	printf("#if (GF_N != %d) || (GF_ARITH != %d)\n"
+		   "  #error \"gf_tab.h is for another config, make clean\"\n"
+		   "#endif\n\n", GF_N, GF_ARITH);
+	printTab("gfVec gfE2V[GF_N]", gfE2V, GF_N);
+	printTab("gfExp gfV2E[GF_N]", gfV2E, GF_N);
+  #if (GF_N <= 256)
+	printf("GF_PAGE_ALIGNED const uint8_t gfNib[GF_N][32] = {");
+	for (int c=0; c<GF_N; c++) {
+		printf("\n\t{");
+		for (int i=0; i<32; i++)
+			printf("%s%d", i ? ", " : "", gfNib[c][i]);
+		printf("},");
+	}
+	printf("\n};\n\n");
+  #endif
+  #if (GF_ARITH == GF_ARITH_ZECH)
+	printTab("gfExp zechLog[GF_N]", zechLog, GF_N);
+  #elif (GF_ARITH == GF_ARITH_TAB)
+	printTab("gfExp gfMulTab[GF_N][GF_N]", &gfMulTab[0][0], GF_N * GF_N);
+  #endif
+  #if (GF_N > 256)
+	printf("const uint32_t gfClK[3] = {0x%x, 0x%x, 0x%x};\n",
+		   gfClK[0], gfClK[1], gfClK[2]);
+  #endif
+	return 0;
+}
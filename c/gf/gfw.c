@@ -0,0 +1,237 @@
+// -----------------------------------------------------------------------------
+// Wide fields GF(2^24), GF(2^32) without lookup tables, see gfw.h
+//
+// The polynomial kernels sum up products unreduced (max. 2n-1 bits in a
+// 64-bit word) and reduce only once per result, so most multiplications cost
+// a single carry-less product.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include "gfw.h"
+
+#if defined(__PCLMUL__)
+  #include <wmmintrin.h>
+const int gfwClmul = 1;
+#else
+const int gfwClmul = 0;
+#endif
+
+#define GFW_CHUNK	256		// window of gfwPolRem(), in coefficients
+
+
+// -----------------------------------------------------------------------------
+// carry-less product a * b, deg(a) + deg(b) < 64
+// -----------------------------------------------------------------------------
+static inline uint64_t gfwClMul(uint64_t a, uint64_t b)
+{
+  #if defined(__PCLMUL__)
+	__m128i p = _mm_clmulepi64_si128(_mm_cvtsi64_si128(a), _mm_cvtsi64_si128(b), 0x00);
+	return _mm_cvtsi128_si64(p);
+  #else
+	uint64_t r = 0;
+	for (; b; b>>=1, a<<=1)
+		if (b & 1)
+			r ^= a;
+	return r;
+  #endif
+}
+
+
+// -----------------------------------------------------------------------------
+// Barrett reduction u % GFW_POL, deg(u) < 2n
+// -----------------------------------------------------------------------------
+static inline gfw gfwRed(uint64_t u)
+{
+	uint64_t q = gfwClMul(u >> GFW_BITS, GFW_MU) >> GFW_BITS;	// floor(u / P)
+	return (u ^ gfwClMul(q, GFW_POL)) & GFW_ORDER;
+}
+
+
+// -----------------------------------------------------------------------------
+gfw gfwMul(gfw a, gfw b)
+// -----------------------------------------------------------------------------
+{
+	return gfwRed(gfwClMul(a, b));
+}
+
+
+// -----------------------------------------------------------------------------
+gfw gfwPow(gfw a, uint64_t e)
+// -----------------------------------------------------------------------------
+{
+	gfw r = GFW_1;
+	for (; e; e>>=1) {
+		if (e & 1)
+			r = gfwMul(r, a);
+		a = gfwMul(a, a);
+	}
+	return r;
+}
+
+
+// -----------------------------------------------------------------------------
+gfw gfwInv(gfw a)
+// -----------------------------------------------------------------------------
+{
+	return gfwPow(a, GFW_ORDER - 1);	// a^(2^n - 2) = a^-1
+}
+
+
+// -----------------------------------------------------------------------------
+gfw gfwPolEval(
+	const gfw*	A,	// A[nA] ... A[0]
+	int			nA,	// max. deg(A)
+	gfw			x)
+// -----------------------------------------------------------------------------
+{
+	gfw y = GFW_0;
+	for (int i=nA; i>=0; i--)
+		y = gfwMul(y, x) ^ A[i];
+	return y;
+}
+
+
+// -----------------------------------------------------------------------------
+// Synthetic division of the dividend D = X^nB * A in a window of GFW_CHUNK
+// quotient coefficients, sliding down from the top (same as gfPolRemC()).
+// -----------------------------------------------------------------------------
+void gfwPolRem(
+	const gfw*	A,	// in: A[nA] ... A[0]
+	ptrdiff_t	nA,	// in: max. deg(A)
+	const gfw*	B,	// in: denominator B[nB-1] ... B[0]
+	int			nB,	// in: actual deg(B)
+	gfw*		R)	// out: remainder R[nB-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	const int ch = GFW_CHUNK;
+	uint64_t W[nB + ch];			// W[t] = D[lo + t], unreduced
+	ptrdiff_t lo = nA + 1 - ch;
+	for (int t=0; t<nB+ch; t++) {
+		ptrdiff_t d = lo + t;
+		W[t] = (d >= nB) ? A[d - nB] : 0;
+	}
+	for (;;) {
+		for (int t=nB+ch-1; (t >= nB) && (lo + t >= nB); t--) {
+			uint64_t q = gfwRed(W[t]);
+			uint64_t* w = W + t - nB;
+			for (int i=0; i<nB; i++)
+				w[i] ^= gfwClMul(q, B[i]);
+		}
+		if (lo <= 0)
+			break;
+		for (int t=nB-1; t>=0; t--)		// slide down
+			W[ch + t] = W[t];
+		lo -= ch;
+		for (int t=0; t<ch; t++) {
+			ptrdiff_t d = lo + t;
+			W[t] = (d >= nB) ? A[d - nB] : 0;
+		}
+	}
+	for (int i=0; i<nB; i++)
+		R[i] = gfwRed(W[i - lo]);
+}
+
+
+// -----------------------------------------------------------------------------
+void gfwPolEvalTab(
+	gfw*	T,	// out: table
+	int		nY,	// number of locations - 1
+	gfw		x)	// 1st location
+// -----------------------------------------------------------------------------
+{
+	for (int iy=0; iy<=nY; iy++) {
+		gfw xi = gfwMul(x, gfwPow(GFW_Z, nY - iy));
+		gfw p = GFW_1;									// xi^t
+		for (int t=0; t<=GFW_BLOCK; t++) {
+			T[t * (nY + 1) + iy] = p;
+			p = gfwMul(p, xi);
+		}
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+// Per block of coefficients A[i] ... A[i-B+1] (B = GFW_BLOCK):
+//   Y = Y * x^B + sum(A[i-t] * x^(B-1-t))
+// with a single reduction.  The leading (nA+1) % B coefficients are done one
+// by one.
+// -----------------------------------------------------------------------------
+int gfwPolEvalSeq(
+	const gfw*	A,	// in: polynomial (piece) A[nA] ... A[0]
+	ptrdiff_t	nA,	// in: max. deg(A)
+	gfw*		Y,	// in/out: results
+	int			nY,	// in: number of locations - 1
+	const gfw*	T)	// in: table from gfwPolEvalTab()
+// -----------------------------------------------------------------------------
+{
+	const int B = GFW_BLOCK;
+	const int w = nY + 1;
+	ptrdiff_t i = nA;
+	for (; (i + 1) % B; i--)
+		for (int j=0; j<w; j++)
+			Y[j] = gfwRed(gfwClMul(Y[j], T[w + j]) ^ A[i]);
+	for (; i>=0; i-=B) {
+		const gfw* a = A + i - (B - 1);			// a[B-1] = A[i]
+		for (int j=0; j<w; j++) {
+			uint64_t u = gfwClMul(Y[j], T[B * w + j]);
+			for (int t=0; t<B; t++)
+				u ^= gfwClMul(a[t], T[t * w + j]);
+			Y[j] = gfwRed(u);
+		}
+	}
+	gfw nz = 0;
+	for (int j=0; j<w; j++)
+		nz |= Y[j];
+	return nz != 0;
+}
+
+
+// -----------------------------------------------------------------------------
+// For the block of locations i0 ... i0+B-1 with C[j] = A[j] * z^-(i0*j):
+//   A(z^-(i0+s)) = sum(C[j] * z^-(s*j))
+// with a single reduction per location, C is updated once per block.
+// -----------------------------------------------------------------------------
+int gfwPolRoots(
+	const gfw*	A,	// polynomial A[nA] ... A[0]
+	int			nA,	// max. deg(A)
+	size_t		n,	// number of locations
+	size_t*		R,	// out: roots, max. nR
+	int			nR)	// in: max. number of roots to find
+// -----------------------------------------------------------------------------
+{
+	const int B = GFW_BLOCK;
+	gfw T[B][nA + 1], step[nA + 1], C[nA + 1];
+	const gfw zi = gfwInv(GFW_Z);
+	gfw zj = GFW_1;										// z^-j
+	for (int j=0; j<=nA; j++) {
+		gfw p = GFW_1;
+		for (int s=0; s<B; s++) {
+			T[s][j] = p;								// z^-(s*j)
+			p = gfwMul(p, zj);
+		}
+		step[j] = p;									// z^-(B*j)
+		C[j] = A[j];
+		zj = gfwMul(zj, zi);
+	}
+	int nX = 0;
+	for (size_t i0=0; i0<n; i0+=B) {
+		for (int s=0; (s < B) && (i0 + s < n); s++) {
+			uint64_t u = 0;
+			for (int j=0; j<=nA; j++)
+				u ^= gfwClMul(C[j], T[s][j]);
+			if (gfwRed(u) == GFW_0) {
+				R[nX++] = i0 + s;
+				if (nX == nR)
+					return nX;
+			}
+		}
+		for (int j=0; j<=nA; j++)
+			C[j] = gfwMul(C[j], step[j]);
+	}
+	return nX;
+}
@@ -0,0 +1,136 @@
+// -----------------------------------------------------------------------------
+// Wide fields GF(2^24), GF(2^32) without lookup tables, for very long codewords
+// (up to 2^GFW_BITS - 1 symbols).
+//
+// Tables of these fields would need up to 32 GB, so the elements exist in
+// vector representation only (standard polynomial basis, bit i = x^i):
+// addition is XOR, multiplication is a carry-less product (PCLMULQDQ, if
+// enabled at compile time, see Makefile) with Barrett reduction, division
+// goes by Fermat's little theorem.  The primitive element is z = x.
+// The field size is independent of BITS_PER_SYMBOL, so both may be used side
+// by side.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#ifndef _GFW_H
+#define _GFW_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// field size, "make GFW_BITS=24" to override; "make clean" when changing it
+#ifndef GFW_BITS
+  #define GFW_BITS 32
+#endif
+
+#if (GFW_BITS == 24)
+  #define GFW_POL 0x100001bull	// x^24 + x^4 + x^3 + x + 1
+#elif (GFW_BITS == 32)
+  #define GFW_POL 0x1000000c5ull// x^32 + x^7 + x^6 + x^2 + 1
+#else
+  #error "GFW_BITS must be 24 or 32"
+#endif
+// Barrett constant floor(x^2n / GFW_POL); equals GFW_POL, as long as its
+// lower part has degree < n/2
+#define GFW_MU	GFW_POL
+
+// order of the multiplicative group, z^GFW_ORDER = 1
+#define GFW_ORDER	((1ull << GFW_BITS) - 1)
+
+typedef uint32_t gfw;	// element, vector repr.
+
+#define GFW_0	0
+#define GFW_1	1
+#define GFW_Z	2		// primitive element z = x
+
+// 1 if built with PCLMULQDQ, else a portable carry-less multiplication is used
+extern const int gfwClmul;
+
+// Coefficients per block of gfwPolEvalSeq(), gfwPolRoots()
+#define GFW_BLOCK	16
+
+
+// a * b
+// -----------------------------------------------------------------------------
+gfw gfwMul(gfw a, gfw b);
+// -----------------------------------------------------------------------------
+
+
+// a^e
+// -----------------------------------------------------------------------------
+gfw gfwPow(gfw a, uint64_t e);
+// -----------------------------------------------------------------------------
+
+
+// 1 / a, a != 0
+// -----------------------------------------------------------------------------
+gfw gfwInv(gfw a);
+// -----------------------------------------------------------------------------
+
+
+// Evaluate polynomial A at x by Horner's rule
+// -----------------------------------------------------------------------------
+gfw gfwPolEval(
+	const gfw*	A,	// A[nA] ... A[0]
+	int			nA,	// max. deg(A)
+	gfw			x);
+// -----------------------------------------------------------------------------
+
+
+// Remainder R = (X^nB * A) % B with deg(B) = nB and B[nB] = 1 (normalized,
+// not passed), like gfPolDiv1V() but without quotient, so A may be long and
+// needs no copy: the stack holds nB + 256 words.
+// -----------------------------------------------------------------------------
+void gfwPolRem(
+	const gfw*	A,	// in: A[nA] ... A[0]
+	ptrdiff_t	nA,	// in: max. deg(A)
+	const gfw*	B,	// in: denominator B[nB-1] ... B[0]
+	int			nB,	// in: actual deg(B)
+	gfw*		R);	// out: remainder R[nB-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Compute table for gfwPolEvalSeq():
+//   T[t * (nY+1) + iy] = (x * z^(nY-iy))^t
+// for t=0..GFW_BLOCK, iy=0..nY.  T must hold (GFW_BLOCK+1) * (nY+1) words.
+// -----------------------------------------------------------------------------
+void gfwPolEvalTab(
+	gfw*	T,	// out: table
+	int		nY,	// number of locations - 1
+	gfw		x);	// 1st location
+// -----------------------------------------------------------------------------
+
+
+// Evaluate A at nY+1 locations by Horner's rule, in blocks of GFW_BLOCK
+// coefficients with one reduction per block, continuing the evaluation in Y:
+//   Y[iy] = Y[iy] * x_iy^(nA+1) + A(x_iy),  x_iy = x * z^(nY-iy)
+// So A may be passed in pieces, starting with the highest one and Y = 0.
+// Return 0 if all of Y is 0 afterwards, else 1.
+// -----------------------------------------------------------------------------
+int gfwPolEvalSeq(
+	const gfw*	A,	// in: polynomial (piece) A[nA] ... A[0]
+	ptrdiff_t	nA,	// in: max. deg(A)
+	gfw*		Y,	// in/out: results
+	int			nY,	// in: number of locations - 1
+	const gfw*	T);	// in: table from gfwPolEvalTab()
+// -----------------------------------------------------------------------------
+
+
+// Find the roots of A among the locations z^-i, i = 0 ... n-1 (Chien
+// search), stop after nR roots.  Needs no memory but the stack (a table of
+// GFW_BLOCK x (nA+1) words).
+// Return number of roots found, their i in R (ascending).
+// -----------------------------------------------------------------------------
+int gfwPolRoots(
+	const gfw*	A,	// polynomial A[nA] ... A[0]
+	int			nA,	// max. deg(A)
+	size_t		n,	// number of locations
+	size_t*		R,	// out: roots, max. nR
+	int			nR);// in: max. number of roots to find
+// -----------------------------------------------------------------------------
+#endif	// _GFW_H
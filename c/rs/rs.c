@@ -10,45 +10,38 @@
 // published by the Free Software Foundation.
 // -----------------------------------------------------------------------------
 
+#include <stdlib.h>
 #include "rs.h"
+#ifndef GF_GEN
+  #include <rs_tab.h>	// rsGenTab, rsSupTab, generated by rs_gen
+#endif
 
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 
-// Generator polynomial (aka D(X)).  It has n-k roots at the consecutive
-// locations z^1 ... z^(n-k) (narrow-sense BCH code).
-static gfExp rsGen[RS_N_K + 1];
 
-// Super polynomial N(X) = X^m - 1 (m = GF_N-1).  It has roots at all z^i,
-// i=0..m-1.  In GF(16): N(X) = X^15 - 1 = prod(X-z^i) for i = 0..14.  We save
-// only the highest n-k coefficients.
-static gfExp rsSup[RS_N_K];
-
-// Compute generator polynomial and super polynomial
-// (may instead be done at compile time):
-// rsGen(X) = prod(X - z^i) for i = 1 ... n-k
-// rsSup(X) = prod(X - z^i) for i = 0 ... m-1
-//          = X^m - 1
+// Compute rsSup and rsGen of rsInit()
+// Return 0 on success, -1 for a bad config.
 // -----------------------------------------------------------------------------
-void rsInit()
+static int rsGenPol(rsCodec* rs)
 // -----------------------------------------------------------------------------
 {
-	dprintf("---------- rsInit\n");
-
-	gfInit();
+	const int nk = rs->nk;
 
 	// ---------- compute rsSup = X^m - 1 (only upper n-k coeffs)
-	rsSup[RS_N_K - 1] = GF_1;
-	for (int i=RS_N_K - 2; i>=0; i--)
+	gfExp* rsSup = rs->sup;
+	rsSup[nk - 1] = GF_1;
+	for (int i=nk - 2; i>=0; i--)
 		rsSup[i] = GF_0;
 
 	// ---------- compute rsGen:
-	gfExp T[RS_N_K + 1];	// tmp
+	gfExp* rsGen = rs->gen;
+	gfExp* T = rs->ws.P;	// tmp
 	int nD1 = 0;	gfExp* D1 = rsGen;
 	int nD2;		gfExp* D2 = T;
 	D1[0] = GF_1;
 	gfExp Z[2] = {GF_Z(1), 1};			// 1st root of rsGen(X): (X - z^1)
-	for (int i=RS_N_K; i>0; i--) {
+	for (int i=nk; i>0; i--) {
 		nD2 = gfPolMul(D1, nD1, Z, 1, D2);
 		Z[0]++;						// (X - z^i) => (X - z^(i+1))
 		// swap D1 <-> D2:
@@ -64,13 +57,142 @@ void rsInit()
 		// -> check here
 		if (D1[i] == GF_0) {
 			dprintf("!! BAD CONFIG: generator polynomial has 0-coefficient !!\n");
-			rsGen[0] = 1 / rsSup[0];	// throw DBZ-exception (trying to fool compiler)
+			return -1;
 		}
 		rsGen[i] = D1[i];
 	}
+	return 0;
+}
+
+
+// Compute generator polynomial and super polynomial
+// (done at compile time for the configured n-k, see rs_gen.c):
+// rsGen(X) = prod(X - z^i) for i = 1 ... n-k
+// rsSup(X) = prod(X - z^i) for i = 0 ... m-1
+//          = X^m - 1
+// -----------------------------------------------------------------------------
+int rsInit(
+	rsCodec* rs,	// out: codec
+	int n,			// in: codeword length, 1 < n < GF_N
+	int nk)			// in: number of check symbols, 0 < nk < n
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsInit\n");
+
+	if ((n >= GF_N) || (nk <= 0) || (nk >= n))
+		return -1;
+
+	gfInit();
+
+	rs->n = n;
+	rs->nk = nk;
+	rs->k = n - nk;
+
+	// both polynomials and own decoder workspace in one block:
+	// Generator polynomial (aka D(X)).  It has n-k roots at the consecutive
+	// locations z^1 ... z^(n-k) (narrow-sense BCH code).
+	// Super polynomial N(X) = X^m - 1 (m = GF_N-1).  It has roots at all z^i,
+	// i=0..m-1.  In GF(16): N(X) = X^15 - 1 = prod(X-z^i) for i = 0..14.  We
+	// save only the highest n-k coefficients.
+	// (+ syndrome table, if used)
+	int polSize = (nk + 1 + nk) * sizeof(gfExp);
+	int tabSize = 0;
+  #if (GF_N <= 256)
+	tabSize = n * GF_SEQ_ROW(nk - 1) + nk + (nk + 1) * GF_SEQ_ROW(n - 1);
+  #else
+	if (gfClmul)	// + 3 to align the words
+		tabSize = 3 + (GF_CL_BLOCK + 2) * GF_CL_ROW(nk - 1) * sizeof(uint32_t);
+  #endif
+	gfExp* mem = malloc(polSize + rsWorkSize(rs) + tabSize);
+	if (mem == NULL)
+		return -1;
+	rs->upd = NULL;
+	rs->gen = mem;		mem += nk + 1;
+	rs->sup = mem;		mem += nk;
+	rsWorkInit(rs, &rs->ws, mem);
+	rs->kes = RS_KES_EEA;
+  #if (GF_N <= 256)
+	rs->synTab = (uint8_t*) mem + rsWorkSize(rs);
+	rs->genV = rs->synTab + n * GF_SEQ_ROW(nk - 1);
+	rs->chienTab = rs->genV + nk;
+	gfPolEvalSeqTab(rs->synTab, n - 1, nk - 1, GF_Z(1));
+	gfPolEvalSeqTab(rs->chienTab, nk, n - 1, GF_1);	// deg(Q) <= n-k with erasures
+  #else
+	rs->synC = NULL;
+	rs->genC = NULL;
+	if (gfClmul) {
+		uintptr_t p = ((uintptr_t) mem + rsWorkSize(rs) + 3) & ~(uintptr_t) 3;
+		rs->synC = (uint32_t*) p;
+		rs->genC = rs->synC + (GF_CL_BLOCK + 1) * GF_CL_ROW(nk - 1);
+		gfPolEvalTabC(rs->synC, nk - 1, GF_Z(1));
+	}
+  #endif
+
+	gfExp* rsSup = rs->sup;
+	gfExp* rsGen = rs->gen;
+  #ifndef GF_GEN
+	if (nk == RS_N_K) {
+		for (int i=nk-1; i>=0; i--)
+			rsSup[i] = rsSupTab[i];
+		for (int i=nk; i>=0; i--)
+			rsGen[i] = rsGenTab[i];
+	} else
+  #endif
+	if (rsGenPol(rs)) {
+		rsFree(rs);
+		return -1;
+	}
+  #if (GF_N <= 256)
+	for (int i=nk-1; i>=0; i--)
+		rs->genV[i] = gfE2V[rsGen[i]];
+  #else
+	if (gfClmul)
+		for (int i=GF_CL_ROW(nk - 1)-1; i>=0; i--)
+			rs->genC[i] = (i < nk) ? gfClPrep(gfE2V[rsGen[i]]) : 0;
+  #endif
+
+	PRINTPOL("ini: rsSup", rsSup, nk - 1);
+	PRINTPOL("ini: rsGen", rsGen, nk);
+	return 0;
+}
+
+
+// Free memory allocated by rsInit()
+// -----------------------------------------------------------------------------
+void rsFree(rsCodec* rs)
+// -----------------------------------------------------------------------------
+{
+	free(rs->gen);
+	free(rs->upd);
+	rs->gen = NULL;
+	rs->upd = NULL;
+}
+
+
+// -----------------------------------------------------------------------------
+int rsWorkSize(const rsCodec* rs)
+// -----------------------------------------------------------------------------
+{
+	int mSize = 7 * (rs->nk + 1) + 3;	// for the EEA, more than the rest
+	// Sv, M, P, Q  (OPT: determine better limits for deg(P), deg(Q))
+	return (rs->nk + mSize + rs->n + rs->n) * sizeof(gfExp);
+}
+
 
-	PRINTPOL("ini: rsSup", rsSup, RS_N_K - 1);
-	PRINTPOL("ini: rsGen", rsGen, RS_N_K);
+// -----------------------------------------------------------------------------
+void rsWorkInit(
+	const rsCodec* rs,
+	rsWork* ws,		// out: workspace
+	void* mem)		// in: memory of rsWorkSize(rs) bytes
+// -----------------------------------------------------------------------------
+{
+	int mSize = 7 * (rs->nk + 1) + 3;
+	gfExp* m = mem;
+	ws->Sv = m;		m += rs->nk;
+	ws->M  = m;		m += mSize;
+	ws->P  = m;		m += rs->n;
+	ws->Q  = m;
+	rsStatsReset(ws);
 }
 
 
@@ -82,84 +204,778 @@ void rsInit()
 // !! A and R must NOT overlap !!
 // -----------------------------------------------------------------------------
 void rsEncode(
+	rsCodec* rs,
 	gfExp* A,	// !! A[k-1]   ... A[0]   A[-1] ... A[-(n-k)] !!
 	gfExp* R)	// !! R[n-k-1] ... R[0]   R[-1]               !!
 				// !! <-- user part -->   <---- abused  ---->
 // -----------------------------------------------------------------------------
 {
 	dprintf("---------- rsEncode\n");
-	PRINTPOL("enc: A", A, RS_K - 1);
-	gfExp* XA = A - RS_N_K;				// X^(n-k) * A(X)
+	PRINTPOL("enc: A", A, rs->k - 1);
+	gfExp* XA = A - rs->nk;				// X^(n-k) * A(X)
 	// clear XA[0] .. XA[n-k-1]:
-	for (int i=0; i<RS_N_K; i++)
+	for (int i=0; i<rs->nk; i++)
 		XA[i] = GF_0;
-	gfPolDiv1(XA, RS_N - 1, rsGen, RS_N_K, R);
-	PRINTPOL("enc: A", A, RS_K - 1);
-	PRINTPOL("enc: R", R, RS_N_K - 1);
+	gfPolDiv1(XA, rs->n - 1, rs->gen, rs->nk, R);
+	PRINTPOL("enc: A", A, rs->k - 1);
+	PRINTPOL("enc: R", R, rs->nk - 1);
+}
+
+
+// Find errors from the syndrome in ws->Sv (vector repr., deg(S) = nS >= 0).
+// Error positions i (C[i] is wrong) and values (exp. repr.) are returned in
+// ws->M, sorted by descending position:
+//   M[0] ... M[nErr-1]          positions
+//   M[nErr] ... M[2*nErr-1]     values
+// Erasures are found like errors (their error values may be 0).
+// Only positions < n are searched (n < rs->n for a shortened codeword).
+// Return number of errors (in the whole codeword) or -1, if uncorrectable.
+// -----------------------------------------------------------------------------
+static int rsSolve(
+	const rsCodec* rs,
+	rsWork* ws,			// in: workspace
+	int n,				// in: codeword length, n <= rs->n
+	int nS,				// in: deg(S)
+	const int* era,		// in: erasure positions, only with BM
+	int nEra)			// in: number of erasures, max. n-k
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk;
+	gfExp* M = ws->M;		// memory
+	gfExp* P = ws->P;	int nP;
+	gfExp* Q = ws->Q;	int nQ;
+	// full N'(X) (aka rsSup) has deg(N') = n
+	// full syndrome S' has deg(S') <= n-1
+	// We consider only the highest n-k coeffs of S' an N':
+	// deg(N) = deg(N') - k - 1	= n-k-1
+	// deg(S) = deg(S') - k
+	// deg(S)                  <= n-k-1
+	// for deg(S') = n-1  -> deg(S) = n-k-1  (full degree):
+	//   deg(N'/S') = deg(N') - deg(S') = n - (n-1) = 1
+	//   -> number of steps in 1st EEA div is 2
+	// for lower degree: deg(S') = n-1-l    -> deg(S) = n-k-1-l
+	//   -> deg(N'/S') = 1 + l
+	//   l = n-k-1 - deg(S)
+	//   -> deg(N'/S') = 1 + n-k-1 - deg(S) = n-k - deg(S)
+	gfExp* S = ws->Sv;
+	if ((rs->kes == RS_KES_BM) || (nEra > 0)) {
+		// BM needs S[j] = E(z^(j+1)), i.e. Sv reversed, all n-k coeffs:
+		gfPolV2E(ws->Sv, S, nk - 1);
+		for (int i=0, j=nk-1; i<j; i++, j--) {
+			gfExp s = S[i];
+			S[i] = S[j];
+			S[j] = s;
+		}
+		// erasure locator G(X) = prod(1 - z^i X) for erased positions i, in Q:
+		Q[0] = GF_1;
+		for (int e=0; e<nEra; e++) {
+			gfExp x = GF_Z(era[e]);
+			Q[e + 1] = GF_0;
+			for (int i=e+1; i>0; i--)
+				Q[i] = gfAdd(Q[i], gfMul01(Q[i-1], x));
+		}
+		int nL, nW;
+		ws->st.iter += gfPolBM(S, nk - 1, Q, nEra, Q, &nL, P, &nW, M);
+		// L(X) = c * prod(1 - z^i X)  ->  Q(X) = X^nL * L(1/X) = c * prod(X - z^i)
+		// W(X)                        ->  P(X) = X^(nL-1) * W(1/X)
+		// The common factor c cancels out in P / Q'.
+		for (int i=0, j=nL; i<j; i++, j--) {
+			gfExp s = Q[i];
+			Q[i] = Q[j];
+			Q[j] = s;
+		}
+		for (int i=0, j=nW; i<j; i++, j--) {
+			gfExp s = P[i];
+			P[i] = P[j];
+			P[j] = s;
+		}
+		nQ = nL;
+		nP = nW;
+	} else {
+		gfPolV2E(ws->Sv, S, nS);	// convert back to exp
+		nQ = nk - nS;	// deg(N') - deg(S'), see above
+		ws->st.iter += gfPolEEA(rs->sup, nk - 1, S, nS, P, &nP, Q, &nQ, M);
+	}
+	// Now we have:
+	//	Q = prod(X-z^i), for all error and erasure locations i
+	// More than (n-k)/2 errors (n-k - erasures) can't be right:
+	nQ = gfPolDeg(Q, nQ);
+	if ((nQ <= 0) || (2 * nQ - nEra > nk))
+		return -1;
+	// -> find the roots of Q at all positions n-1 ... 0, stop after nQ:
+	gfExp* X = M;		// roots z^i (reuse memory M)
+	gfExp* E = M + nQ;	// error values
+  #if (GF_N <= 256)
+	int nX = gfPolRootsT(Q, nQ, rs->n - 1, n - 1, X, nQ, rs->chienTab);
+  #else
+	int nX = gfPolRoots(Q, nQ, n - 1, X, nQ, E);
+  #endif
+	// Q must split into deg(Q) different roots within the codeword, else the
+	// error locator is wrong (too many errors):
+	if (nX != nQ)
+		return -1;
+	for (int e=0; e<nQ; e++) {
+		// root at z^i => error at C[i]
+		gfExp x = X[e];		// z^i
+		// compute C[i] -= P(x) * N'(x) / Q'(x)
+		// N(X) = X^m - 1, m=2^N-1, odd
+		// N'(X) = X^(m-1) = X^(-1)
+		// N'(x) = x^(-1)
+		gfExp nx = gfInv1(x);	// N'(x) = x^(-1) != 0
+		gfExp px = gfPolEval(P, nP, x);	// P(x) = E(x) / G(x) != 0 since E(x) != 0
+		gfExp qx = gfPolEvalDeriv(Q, nQ, x);
+		if (qx == GF_0)						// no valid error locator
+			return -1;
+		if (px == GF_0) {					// only an erasure may be right
+			if (nEra == 0)
+				return -1;
+			E[e] = GF_0;
+		} else {
+			E[e] = gfDiv1(gfMul11(px, nx), qx);
+		}
+		X[e] = x - GF_Z(0);		// position i
+		dprintf("Q(%d) = 0 => error E(%d)=%d\n", x, X[e], E[e]);
+	}
+	return nQ;
+}
+
+
+// Count a decoded codeword with nFix corrected symbols, -1 if uncorrectable
+// -----------------------------------------------------------------------------
+static inline int rsCount(rsWork* ws, int nFix)
+// -----------------------------------------------------------------------------
+{
+	rsStats* st = &ws->st;
+	st->decoded++;
+	if (nFix < 0) {
+		st->failed++;
+		return nFix;
+	}
+	st->clean += (nFix == 0);
+	st->corrected += nFix;
+	st->hist[MIN(nFix, RS_STATS_HIST - 1)]++;
+	return nFix;
+}
+
+
+// Correct codeword C in place.
+// Return number of corrected symbols in the information part or -1, if the
+// codeword was detected to be uncorrectable (C is then left unchanged).
+// -----------------------------------------------------------------------------
+static int rsCorrect(
+	const rsCodec* rs,
+	rsWork* ws,			// in: workspace
+	gfExp* C,			// in/out: codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	const int* era,		// in: erasure positions
+	int nEra)			// in: number of erasures
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk;
+	PRINTPOL("dec: C", C, n - 1);
+	gfVec* Sv = ws->Sv;		// syndrome in vector representation
+	// calculate syndrome using the DFT.  If it is 0, we're done:
+  #if (GF_N <= 256)
+	if (! gfPolEvalSeqT(C, n - 1, Sv, nk - 1, rs->synTab))
+		return rsCount(ws, 0);
+  #else
+	gfPolEvalSeq(C, n - 1, Sv, nk - 1, GF_Z(1));
+  #endif
+	PRINTPOL("dec: Sv", Sv, nk - 1);
+	int nS = gfPolDeg(Sv, nk - 1);
+	// Else find the errors:
+	if (nS < 0)
+		return rsCount(ws, 0);
+	int nErr = rsSolve(rs, ws, n, nS, era, nEra);
+	if (nErr <= 0)
+		return rsCount(ws, nErr);
+	const gfExp* X = ws->M;
+	const gfExp* E = ws->M + nErr;
+	int nInfo = 0, nFix = 0;
+	for (int e=0; e<nErr; e++) {
+		C[X[e]] = gfSub(C[X[e]], E[e]);
+		nInfo += (X[e] >= nk) && (E[e] != GF_0);
+		nFix += E[e] != GF_0;
+	}
+	rsCount(ws, nFix);
+	return nInfo;
 }
 
 
 // Compute information word from code word, correcting up to n-k/2 errors.
 // -----------------------------------------------------------------------------
-void rsDecode(
+int rsDecode(
+	rsCodec* rs,
+	gfExp* C,	// in: codeword     C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	gfExp* A)	// out: info word   A[k-1] ... A[0]
+// -----------------------------------------------------------------------------
+{
+	return rsDecodeWs(rs, &rs->ws, C, A);
+}
+
+
+// Same with explicit workspace, reentrant.
+// -----------------------------------------------------------------------------
+int rsDecodeWs(
+	const rsCodec* rs,
+	rsWork* ws,	// in: workspace, see rsWorkInit()
 	gfExp* C,	// in: codeword     C[n-1] ... C[n-k] C[n-k-1] ... C[0]
 	gfExp* A)	// out: info word   A[k-1] ... A[0]
 // -----------------------------------------------------------------------------
 {
 	dprintf("---------- rsDecode\n");
-	PRINTPOL("dec: C", C, RS_N - 1);
-	static gfVec Sv[RS_N_K];	// syndrome in vector representation
-	// calculate syndrome using the DFT:
-	gfPolEvalSeq(C, RS_N - 1, Sv, RS_N_K - 1, GF_Z(1));
-	PRINTPOL("dec: Sv", Sv, RS_N_K - 1);
-	#define MSIZE1 (7 * (RS_N_K + 1) + 3)	// for the EEA
-	#define MSIZE2 (RS_K)					// to evaluate Q(X) at K locations
-	static gfExp M[MAX(MSIZE1, MSIZE2)];	// memory
-	static gfExp P[RS_N];	int nP;	// OPT: determine better limits for deg(P), deg(Q)
-	static gfExp Q[RS_N];	int nQ;
-	int nS = gfPolDeg(Sv, RS_N_K - 1);
-	// If the syndrome is 0, we're done.  Else start the EEA:
-	if (nS >= 0) {					// S != 0
-		// full N'(X) (aka rsSup) has deg(N') = n
-		// full syndrome S' has deg(S') <= n-1
-		// We consider only the highest n-k coeffs of S' an N':
-		// deg(N) = deg(N') - k - 1	= n-k-1
-		// deg(S) = deg(S') - k
-		// deg(S)                  <= n-k-1
-		// for deg(S') = n-1  -> deg(S) = n-k-1  (full degree):
-		//   deg(N'/S') = deg(N') - deg(S') = n - (n-1) = 1
-		//   -> number of steps in 1st EEA div is 2
-		// for lower degree: deg(S') = n-1-l    -> deg(S) = n-k-1-l
-		//   -> deg(N'/S') = 1 + l
-		//   l = n-k-1 - deg(S)
-		//   -> deg(N'/S') = 1 + n-k-1 - deg(S) = n-k - deg(S)
-		gfExp* S = Sv;
-		gfPolV2E(Sv, S, nS);	// convert back to exp
-		nQ = RS_N_K - nS;	// deg(N') - deg(S'), see above
-		gfPolEEA(rsSup, RS_N_K - 1, S, nS, P, &nP, Q, &nQ, M);
-		// Now we have:
-		//	Q = prod(X-z^i), for all error locations i
-		// -> find roots of Q that are in the information part n-k...n-1
-		//    (we don't care for the others):
-		gfVec* Vv = M;	// values of Q(z^i) (reuse memory M)
-		gfPolEvalSeq(Q, nQ, Vv, RS_K - 1, GF_Z(RS_N_K));
-		for (int i=RS_N-1; i>=RS_N_K; i--) {
-			if (*(Vv++) == GF_0) {	// root at z^i => error at C[i]
-				gfExp x = GF_Z(i);	// z^i
-				// compute C[i] -= P(x) * N'(x) / Q'(x)
-				// N(X) = X^m - 1, m=2^N-1, odd
-				// N'(X) = X^(m-1) = X^(-1)
-				// N'(x) = x^(-1)
-				gfExp nx = gfInv1(x);	// N'(x) = x^(-1) != 0
-				gfExp px = gfPolEval(P, nP, x);	// P(x) = E(x) / G(x) != 0 since E(x) != 0
-				gfExp qx = gfPolEvalDeriv(Q, nQ, x);
-				gfExp e = gfDiv1(gfMul11(px, nx), qx);
-				C[i] = gfSub(C[i], e);
-				dprintf("Q(%d) = 0 => error E(%d)=%d; new C[%d]=%d\n", x, i, e, i, C[i]);
+	int r = rsCorrect(rs, ws, C, NULL, 0);
+	if (A == NULL)
+		return r;
+	for (int i=0; i<rs->k; i++)
+		A[i] = C[i + rs->nk];
+	PRINTPOL("dec: A", A, rs->k - 1);
+	return r;
+}
+
+
+// Encode cnt codewords in one call.
+// -----------------------------------------------------------------------------
+void rsEncodeBatch(
+	const rsCodec* rs,
+	gfExp* C,		// in/out: 1st codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	int stride,		// in: distance between codewords (min: n)
+	int cnt)		// in: number of codewords
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsEncodeBatch\n");
+	const int n = rs->n, nk = rs->nk;
+  #if (GF_N <= 256)
+	// as rsEncodeShortV(), with one copy W for the whole batch:
+	uint8_t W[n];
+	for (; cnt>0; cnt--, C+=stride) {
+		for (int i=0; i<nk; i++)
+			W[i] = GF_0;
+		for (int i=nk; i<n; i++)
+			W[i] = gfE2V[C[i]];
+		gfPolDiv1V(W, n - 1, rs->genV, nk);
+		for (int i=0; i<nk; i++)
+			C[i] = gfV2E[W[i]];
+	}
+  #else
+	const gfExp* gen = rs->gen;
+	gfExp R_[nk + 1];
+	gfExp* R = R_ + 1;				// remainder incl. R[-1]
+	for (; cnt>0; cnt--, C+=stride) {
+		// C is X^(n-k) * A(X) once the check part is cleared:
+		for (int i=0; i<nk; i++)
+			C[i] = GF_0;
+		gfPolDiv1(C, n - 1, (gfExp*) gen, nk, R);
+		for (int i=0; i<nk; i++)
+			C[i] = R[i];
+	}
+  #endif
+}
+
+
+// Decode cnt codewords in one call.
+// -----------------------------------------------------------------------------
+void rsDecodeBatch(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfExp* C,		// in/out: 1st codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	int stride,		// in: distance between codewords (min: n)
+	gfExp* A,		// out: 1st info word A[k-1] ... A[0]; may be NULL
+	int aStride,	// in: distance between info words (min: k)
+	int cnt,		// in: number of codewords
+	int* status)	// out: status[i] as returned by rsDecode(); may be NULL
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsDecodeBatch\n");
+	const int nk = rs->nk, k = rs->k;
+	for (int c=0; c<cnt; c++, C+=stride) {
+		int r = rsCorrect(rs, ws, C, NULL, 0);
+		if (status)
+			status[c] = r;
+		if (A) {
+			for (int i=0; i<k; i++)
+				A[i] = C[i + nk];
+			A += aStride;
+		}
+	}
+}
+
+
+// Compute the syndrome of codeword C = (A, R) in vector repr. (see
+// gfPolEvalSeq() for its order):
+//   Sv[nk-1-j] = sum(C[i] * z^((j+1) * i))
+// The info part has k = n - nk symbols, the missing ones of a shortened
+// codeword are 0 and not visited at all.
+// Return 0 for a clean codeword (Sv is then not set), else 1.
+// -----------------------------------------------------------------------------
+static int rsSyndromeV(
+	const rsCodec* rs,
+	int n,				// in: codeword length, n <= rs->n
+	const gfSym* A,		// in: info part   A[k-1] ... A[0]
+	const gfSym* R,		// in: check part  R[n-k-1] ... R[0]
+	gfVec* Sv)			// out: syndrome (vector repr.)
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk, k = n - nk;
+  #if (GF_N <= 256)
+	// row i of the table holds all z^((j+1) * i), R starts at row 0, A at nk:
+	const int w = GF_SEQ_ROW(nk - 1);
+	uint8_t Y[w];
+	for (int j=0; j<w; j++)
+		Y[j] = GF_0;
+	gfPolEvalSeqTV(R, nk - 1, Y, nk - 1, rs->synTab);
+	if (! gfPolEvalSeqTV(A, k - 1, Y, nk - 1, rs->synTab + nk * w))
+		return 0;
+	for (int j=0; j<nk; j++)
+		Sv[j] = Y[j];
+	return 1;
+  #else
+	if (gfClmul) {
+		// Horner's rule over A, then R, without tables, see gfPolEvalC():
+		const int w = GF_CL_ROW(nk - 1);
+		uint32_t Y[w];
+		for (int j=0; j<w; j++)
+			Y[j] = GF_0;
+		gfPolEvalC(A, k - 1, Y, nk - 1, rs->synC);
+		if (! gfPolEvalC(R, nk - 1, Y, nk - 1, rs->synC))
+			return 0;
+		for (int j=0; j<nk; j++)
+			Sv[j] = Y[j];
+		return 1;
+	}
+	for (int j=0; j<nk; j++)
+		Sv[j] = GF_0;
+	for (int p=0; p<2; p++) {
+		const gfSym* Cv = p ? A : R;				// C[i0] ... C[i0+nC-1]
+		const int nC = p ? k : nk;
+		const int i0 = p ? nk : 0;
+		for (int i=0; i<nC; i++) {
+			gfExp c = gfV2E[Cv[i]];
+			if (c == GF_0)
+				continue;
+			gfExp zi = GF_Z(i0 + i);				// i0 + i < n < GF_N - 1
+			gfExp v = gfMul11(c, zi);				// C[i] * z^i
+			for (int j=nk-1; j>0; j--) {
+				Sv[j] ^= gfE2V[v];
+				v = gfMul11(v, zi);					// C[i] * (z^i)^(nk-j+1)
 			}
+			Sv[0] ^= gfE2V[v];
 		}
 	}
-	for (int i=0; i<RS_K; i++)
-		A[i] = C[i + RS_N_K];
-	PRINTPOL("dec: A", A, RS_K - 1);
+	return gfPolDeg(Sv, nk - 1) >= 0;
+  #endif
+}
+
+
+// Compute check symbols from information symbols, all in vector repr.
+// -----------------------------------------------------------------------------
+void rsEncodeV(
+	const rsCodec* rs,
+	const gfSym* A,	// in: info word    A[k-1] ... A[0]
+	gfSym* R)		// out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	rsEncodeShortV(rs, rs->n, A, R);
+}
+
+
+// Same for a shortened codeword: the division runs over the n-1 coeffs of
+// this codeword only, not over those of the codec.
+// -----------------------------------------------------------------------------
+void rsEncodeShortV(
+	const rsCodec* rs,
+	int n,			// in: codeword length, nk < n <= rs->n
+	const gfSym* A,	// in: info word    A[k-1] ... A[0], k = n - nk
+	gfSym* R)		// out: check part  R[nk-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsEncodeShortV\n");
+	const int nk = rs->nk, k = n - nk;
+  #if (GF_N <= 256)
+	// X^(n-k) * A(X) % D(X) by synthetic division on a copy:
+	uint8_t W[n];
+	for (int i=0; i<nk; i++)
+		W[i] = GF_0;
+	for (int i=0; i<k; i++)
+		W[nk + i] = A[i];
+	gfPolDiv1V(W, n - 1, rs->genV, nk);
+	for (int i=0; i<nk; i++)
+		R[i] = W[i];
+  #else
+	// one reduction per info symbol: for few check symbols the shift register
+	// is faster, as long as the tables fit into the L1 cache (see bench_rs):
+	if (gfClmul && ((nk >= 8) || (GF_N > 4096))) {
+		gfPolRemC(A, k - 1, rs->genC, nk, R);
+		return;
+	}
+	// same with a shift register directly in R (no copy of A needed):
+	const gfExp* gen = rs->gen;
+	for (int i=0; i<nk; i++)
+		R[i] = GF_0;
+	for (int ia=k-1; ia>=0; ia--) {
+		gfVec fb = A[ia] ^ R[nk - 1];			// feedback
+		if (fb == GF_0) {
+			for (int ir=nk-1; ir>0; ir--)
+				R[ir] = R[ir-1];
+			R[0] = GF_0;
+			continue;
+		}
+		gfExp q = gfV2E[fb];
+		for (int ir=nk-1; ir>0; ir--)			// gen[ir] != 0, see rsInit()
+			R[ir] = R[ir-1] ^ gfE2V[gfMul11(q, gen[ir])];
+		R[0] = gfE2V[gfMul11(q, gen[0])];
+	}
+  #endif
+}
+
+
+// Correct codeword (vector repr.) in place, see rsCorrect()
+// -----------------------------------------------------------------------------
+static int rsCorrectV(
+	const rsCodec* rs,
+	rsWork* ws,			// in: workspace
+	int n,				// in: codeword length, n <= rs->n
+	gfSym* A,			// in/out: info part   A[k-1] ... A[0]
+	gfSym* R,			// in/out: check part  R[n-k-1] ... R[0]
+	const int* era,		// in: erasure positions
+	int nEra)			// in: number of erasures
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk;
+	gfVec* Sv = ws->Sv;
+	if (! rsSyndromeV(rs, n, A, R, Sv))
+		return rsCount(ws, 0);	// clean codeword: nothing written at all
+	PRINTPOL("dcv: Sv", Sv, nk - 1);
+	int nS = gfPolDeg(Sv, nk - 1);
+	int nErr = rsSolve(rs, ws, n, nS, era, nEra);
+	if (nErr <= 0)
+		return rsCount(ws, nErr);
+	const gfExp* X = ws->M;
+	const gfExp* E = ws->M + nErr;
+	int nInfo = 0, nFix = 0;
+	for (int e=0; e<nErr; e++) {
+		if (X[e] >= nk) {
+			A[X[e] - nk] ^= gfE2V[E[e]];
+			nInfo += E[e] != GF_0;
+		} else {
+			R[X[e]] ^= gfE2V[E[e]];
+		}
+		nFix += E[e] != GF_0;
+	}
+	rsCount(ws, nFix);
+	return nInfo;
+}
+
+
+// Correct codeword (vector repr.) in place
+// -----------------------------------------------------------------------------
+int rsDecodeV(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfSym* A,		// in/out: info part   A[k-1] ... A[0]
+	gfSym* R)		// in/out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsDecodeV\n");
+	return rsCorrectV(rs, ws, rs->n, A, R, NULL, 0);
+}
+
+
+// Correct shortened codeword (vector repr.) in place
+// -----------------------------------------------------------------------------
+int rsDecodeShortV(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	int n,			// in: codeword length, nk < n <= rs->n
+	gfSym* A,		// in/out: info part   A[k-1] ... A[0], k = n - nk
+	gfSym* R)		// in/out: check part  R[nk-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsDecodeShortV\n");
+	if ((n <= rs->nk) || (n > rs->n))
+		return -1;
+	return rsCorrectV(rs, ws, n, A, R, NULL, 0);
+}
+
+
+// Parity columns U[i * nk ...] = X^(nk+i) % rsGen, one from the other:
+//   X^nk % rsGen = rsGen - X^nk
+//   X^(nk+i+1) % rsGen = X * (X^(nk+i) % rsGen) - f * rsGen
+// with f the coefficient of X^(nk-1) in X^(nk+i) % rsGen
+// -----------------------------------------------------------------------------
+int rsUpdateInit(rsCodec* rs)
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsUpdateInit\n");
+	const int nk = rs->nk, k = rs->k;
+	const gfExp* gen = rs->gen;
+	if (rs->upd != NULL)
+		return 0;
+	gfExp* U = malloc((size_t) k * nk * sizeof(gfExp));
+	if (U == NULL)
+		return -1;
+	for (int j=0; j<nk; j++)
+		U[j] = gen[j];
+	for (int i=1; i<k; i++) {
+		const gfExp* P = U + (i - 1) * nk;
+		gfExp* Q = U + i * nk;
+		const gfExp f = P[nk - 1];
+		for (int j=nk-1; j>0; j--)				// gen[j] != 0, see rsInit()
+			Q[j] = gfAdd(P[j - 1], gfMul01(f, gen[j]));
+		Q[0] = gfMul01(f, gen[0]);
+	}
+	rs->upd = U;
+	return 0;
+}
+
+
+// R += (Anew - Aold) * parity columns
+// -----------------------------------------------------------------------------
+void rsUpdate(
+	const rsCodec* rs,
+	int i,				// in: position of the 1st changed info symbol
+	const gfExp* Aold,	// in: old info symbols  Aold[cnt-1] ... Aold[0]
+	const gfExp* Anew,	// in: new info symbols  Anew[cnt-1] ... Anew[0]
+	int cnt,			// in: number of changed info symbols
+	gfExp* R)			// in/out: check part    R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk;
+	for (int c=0; c<cnt; c++) {
+		const gfExp d = gfSub(Anew[c], Aold[c]);
+		if (d == GF_0)
+			continue;
+		const gfExp* U = rs->upd + (size_t) (i + c) * nk;
+		for (int j=0; j<nk; j++)
+			R[j] = gfAdd(R[j], gfMul01(U[j], d));
+	}
+}
+
+
+// Same in vector repr.
+// -----------------------------------------------------------------------------
+void rsUpdateV(
+	const rsCodec* rs,
+	int i,				// in: position of the 1st changed info symbol
+	const gfSym* Aold,	// in: old info symbols  Aold[cnt-1] ... Aold[0]
+	const gfSym* Anew,	// in: new info symbols  Anew[cnt-1] ... Anew[0]
+	int cnt,			// in: number of changed info symbols
+	gfSym* R)			// in/out: check part    R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk;
+	for (int c=0; c<cnt; c++) {
+		const gfVec dv = Anew[c] ^ Aold[c];
+		if (dv == GF_0)
+			continue;
+		const gfExp d = gfV2E[dv];
+		const gfExp* U = rs->upd + (size_t) (i + c) * nk;
+		for (int j=0; j<nk; j++)
+			R[j] ^= gfE2V[gfMul01(U[j], d)];
+	}
+}
+
+
+// Check codeword, syndrome only
+// -----------------------------------------------------------------------------
+int rsCheck(
+	const rsCodec* rs,
+	const gfExp* C)		// in: codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk;
+	gfVec Sv[nk];
+  #if (GF_N <= 256)
+	return gfPolEvalSeqT((gfExp*) C, n - 1, Sv, nk - 1, rs->synTab);
+  #else
+	gfPolEvalSeq((gfExp*) C, n - 1, Sv, nk - 1, GF_Z(1));
+	return gfPolDeg(Sv, nk - 1) >= 0;
+  #endif
+}
+
+
+// Check codeword (vector repr.), syndrome only
+// -----------------------------------------------------------------------------
+int rsCheckV(
+	const rsCodec* rs,
+	const gfSym* A,		// in: info part   A[k-1] ... A[0]
+	const gfSym* R)		// in: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	gfVec Sv[rs->nk];
+	return rsSyndromeV(rs, rs->n, A, R, Sv);
+}
+
+
+// Check cnt codewords
+// -----------------------------------------------------------------------------
+int rsCheckBatch(
+	const rsCodec* rs,
+	const gfExp* C,		// in: 1st codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	int stride,			// in: distance between codewords (min: n)
+	int cnt,			// in: number of codewords
+	int* status)		// out: status per codeword, 0 or 1; may be NULL
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsCheckBatch\n");
+	int nDirty = 0;
+	for (int c=0; c<cnt; c++, C+=stride) {
+		int r = rsCheck(rs, C);
+		nDirty += r;
+		if (status)
+			status[c] = r;
+	}
+	return nDirty;
+}
+
+
+// Check cnt codewords (vector repr.).  For GF_N <= 256, gfPolCheckSeqV()
+// tests them in blocks of up to 256 at a time; only the flags of a block
+// are buffered.
+// -----------------------------------------------------------------------------
+int rsCheckBatchV(
+	const rsCodec* rs,
+	const gfSym* C,		// in: 1st codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	int stride,			// in: distance between codewords (min: n)
+	int cnt,			// in: number of codewords
+	int* status)		// out: status per codeword, 0 or 1; may be NULL
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsCheckBatchV\n");
+	const int n = rs->n, nk = rs->nk;
+	int nDirty = 0;
+  #if (GF_N <= 256)
+	uint8_t nz[256];
+	for (int c0=0; c0<cnt; c0+=256) {
+		const int nc = MIN(256, cnt - c0);
+		nDirty += gfPolCheckSeqV(C + (size_t) c0 * stride, stride, nc, n - 1,
+								 nk - 1, rs->synTab, status ? nz : NULL);
+		if (status)
+			for (int c=0; c<nc; c++)
+				status[c0 + c] = nz[c];
+	}
+  #else
+	gfVec Sv[nk];
+	for (int c=0; c<cnt; c++, C+=stride) {
+		int r = rsSyndromeV(rs, n, C + nk, C, Sv);
+		nDirty += r;
+		if (status)
+			status[c] = r;
+	}
+  #endif
+	return nDirty;
+}
+
+
+// -----------------------------------------------------------------------------
+void rsStatsGet(
+	const rsWork* ws,	// in: workspace
+	rsStats* st)		// out: snapshot
+// -----------------------------------------------------------------------------
+{
+	*st = ws->st;
+}
+
+
+// -----------------------------------------------------------------------------
+void rsStatsReset(rsWork* ws)
+// -----------------------------------------------------------------------------
+{
+	rsStats* st = &ws->st;
+	st->decoded = st->clean = st->corrected = st->failed = st->iter = 0;
+	for (int i=0; i<RS_STATS_HIST; i++)
+		st->hist[i] = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+void rsStatsAdd(
+	rsStats* sum,		// in/out: sum
+	const rsStats* st)	// in: snapshot
+// -----------------------------------------------------------------------------
+{
+	sum->decoded += st->decoded;
+	sum->clean += st->clean;
+	sum->corrected += st->corrected;
+	sum->failed += st->failed;
+	sum->iter += st->iter;
+	for (int i=0; i<RS_STATS_HIST; i++)
+		sum->hist[i] += st->hist[i];
+}
+
+
+// Copy the erasure positions to U for rsSolve(), without duplicates (a
+// position listed twice would be a double root of the erasure locator, which
+// the error search takes for an uncorrectable codeword).
+// Return the number of distinct positions, or -1 if a position is out of
+// range or there are more than n-k of them.
+// -----------------------------------------------------------------------------
+static int rsEraList(
+	const rsCodec* rs,
+	const int* era,		// in: erasure positions
+	int nEra,			// in: number of erasures
+	int* U)				// out: distinct positions, max. n-k
+// -----------------------------------------------------------------------------
+{
+	if (nEra < 0)
+		return -1;
+	char seen[rs->n];
+	for (int i=0; i<rs->n; i++)
+		seen[i] = 0;
+	int nU = 0;
+	for (int e=0; e<nEra; e++) {
+		if ((era[e] < 0) || (era[e] >= rs->n))
+			return -1;
+		if (seen[era[e]])
+			continue;
+		if (nU == rs->nk)
+			return -1;
+		seen[era[e]] = 1;
+		U[nU++] = era[e];
+	}
+	return nU;
+}
+
+
+// Errors-and-erasures decoding
+// -----------------------------------------------------------------------------
+int rsDecodeEra(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfExp* C,		// in/out: codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	gfExp* A,		// out: info word   A[k-1] ... A[0]; may be NULL
+	const int* era,	// in: erasure positions (C[era[i]] is bad)
+	int nEra)		// in: number of erasures
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsDecodeEra\n");
+	int U[rs->nk];
+	int nU = rsEraList(rs, era, nEra, U);
+	if (nU < 0)
+		return -1;
+	int r = rsCorrect(rs, ws, C, U, nU);
+	if (A == NULL)
+		return r;
+	for (int i=0; i<rs->k; i++)
+		A[i] = C[i + rs->nk];
+	return r;
+}
+
+
+// Errors-and-erasures decoding, vector repr.
+// -----------------------------------------------------------------------------
+int rsDecodeEraV(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfSym* A,		// in/out: info part   A[k-1] ... A[0]
+	gfSym* R,		// in/out: check part  R[n-k-1] ... R[0]
+	const int* era,	// in: erasure positions, 0 ... n-1 as in rsDecodeEra()
+	int nEra)		// in: number of erasures
+// -----------------------------------------------------------------------------
+{
+	dprintf("---------- rsDecodeEraV\n");
+	int U[rs->nk];
+	int nU = rsEraList(rs, era, nEra, U);
+	if (nU < 0)
+		return -1;
+	return rsCorrectV(rs, ws, rs->n, A, R, U, nU);
 }
@@ -16,13 +16,82 @@
 #include <ecc_cfg.h>
 #include <gf/gf.h>
 
-// Compute generator polynomial and super polynomial
-// (may instead be done at compile time):
+// Decoder statistics, see rsStatsGet().  Corrected symbols are those in the
+// whole codeword whose value changed (not erasures that were right).
+#define RS_STATS_HIST	16	// histogram: 0 ... 14 corrected symbols, 15 or more
+typedef struct {
+	uint64_t	decoded;	// codewords decoded
+	uint64_t	clean;		// thereof without errors (syndrome 0)
+	uint64_t	corrected;	// symbols corrected
+	uint64_t	failed;		// codewords detected as uncorrectable
+	uint64_t	iter;		// iterations of the key equation solver
+	uint64_t	hist[RS_STATS_HIST];	// successfully decoded codewords by
+										// number of corrected symbols
+} rsStats;
+
+// Decoder workspace.  Each thread decoding concurrently with the same codec
+// needs its own one, see rsWorkSize(), rsWorkInit().  It also counts the
+// decoder statistics of its thread.
+typedef struct {
+	gfVec*	Sv;		// syndrome in vector representation
+	gfExp*	M;		// key equation memory, also used for the error search
+	gfExp*	P;
+	gfExp*	Q;
+	rsStats	st;		// statistics, cleared by rsWorkInit()
+} rsWork;
+
+
+// Key equation solvers (rsCodec.kes).  Both give the same error locator and
+// evaluator, see bench_kes for their speed.
+#define RS_KES_EEA	0	// extended Euclidean algorithm, gfPolEEA()
+#define RS_KES_BM	1	// inversionless Berlekamp-Massey algorithm, gfPolBM()
+
+
+// Codec context.  The field GF(2^n) is fixed at compile time (ecc_cfg.h), but
+// codeword length and number of check symbols are chosen per codec, so one
+// process can use several codes side by side.  All codecs share the field
+// tables gfE2V/gfV2E.
+// Members are read-only for the user, except kes.
+typedef struct {
+	int		n;		// codeword length (info + check part), n < GF_N
+	int		nk;		// number of check symbols n-k (min: 1)
+	int		k;		// number of information symbols
+	gfExp*	gen;	// generator polynomial rsGen, deg = n-k
+	gfExp*	sup;	// super polynomial rsSup, only highest n-k coeffs
+	rsWork	ws;		// workspace used by rsDecode()
+	int		kes;	// key equation solver: RS_KES_EEA (default) or RS_KES_BM
+	gfExp*	upd;	// parity columns of rsUpdate(), NULL before rsUpdateInit()
+  #if (GF_N <= 256)
+	uint8_t* synTab;// table to compute the syndrome, see gfPolEvalSeqTab()
+	uint8_t* genV;	// rsGen in vector repr. (without highest coeff = 1)
+	uint8_t* chienTab;// table for the error search, see gfPolRootsT()
+  #else
+	uint32_t* synC;	// table to compute the syndrome, see gfPolEvalTabC()
+	uint32_t* genC;	// rsGen for gfPolRemC() (without highest coeff = 1)
+					// both NULL if gf.c was built without PCLMULQDQ
+  #endif
+} rsCodec;
+
+
+// Initialize codec for an (n, k) code with nk = n-k check symbols:
+// allocate memory and compute generator polynomial and super polynomial
+// (for the configured n-k they are generated at build time, see rs_gen.c):
 // rsGen(X) = prod(X - z^i) for i = 1 ... n-k  (aka D(X))
 // rsSup(X) = prod(X - z^i) for i = 0 ... m-1  (aka N(X))
 //          = X^m - 1
+// Return 0 on success, -1 on invalid parameters or if out of memory.
+// -----------------------------------------------------------------------------
+int rsInit(
+	rsCodec* rs,	// out: codec
+	int n,			// in: codeword length, 1 < n < GF_N
+	int nk);		// in: number of check symbols, 0 < nk < n
+// -----------------------------------------------------------------------------
+
+
+// Free memory allocated by rsInit()
+// -----------------------------------------------------------------------------
+void rsFree(rsCodec* rs);
 // -----------------------------------------------------------------------------
-void rsInit();
 
 
 // Compute check symbols from information symbols.
@@ -33,6 +102,7 @@ void rsInit();
 // !! A and R must NOT overlap !!
 // -----------------------------------------------------------------------------
 void rsEncode(
+	rsCodec* rs,
 	gfExp* A,	// !! A[k-1]   ... A[0]   A[-1] ... A[-(n-k)] !!
 	gfExp* R);	// !! R[n-k-1] ... R[0]   R[-1]               !!
 				// !! <-- user part -->   <---- abused  ---->
@@ -40,9 +110,300 @@ void rsEncode(
 
 
 // Compute information word from code word, correcting up to n-k/2 errors.
+// C is corrected in place, including errors in the check part.
+// Return number of corrected symbols in the information part or -1, if the
+// codeword was detected to be uncorrectable (the error locator does not have
+// as many roots within the codeword as its degree).
+// Uses the codec's own workspace, so it must not be called concurrently with
+// the same codec.  See rsDecodeWs() for that.
 // -----------------------------------------------------------------------------
-void rsDecode(
+int rsDecode(
+	rsCodec* rs,
 	gfExp* C,	// in: codeword     C[n-1] ... C[n-k] C[n-k-1] ... C[0]
 	gfExp* A);	// out: info word   A[k-1] ... A[0]
 // -----------------------------------------------------------------------------
+
+
+// Return size in bytes of the memory needed for a decoder workspace
+// -----------------------------------------------------------------------------
+int rsWorkSize(const rsCodec* rs);
+// -----------------------------------------------------------------------------
+
+
+// Set up decoder workspace in caller-owned memory of rsWorkSize() bytes.
+// The workspace is valid for all codecs with the same n and n-k.
+// -----------------------------------------------------------------------------
+void rsWorkInit(
+	const rsCodec* rs,
+	rsWork* ws,		// out: workspace
+	void* mem);		// in: memory of rsWorkSize(rs) bytes
+// -----------------------------------------------------------------------------
+
+
+// Same as rsDecode() but with explicit workspace.  It touches no static or
+// codec-owned scratch memory, so several threads may decode with the same
+// codec at once, each with its own workspace.
+// If A is NULL, nothing is copied: the corrected info part is C[n-1] ...
+// C[n-k], and a clean codeword costs only the syndrome.
+// -----------------------------------------------------------------------------
+int rsDecodeWs(
+	const rsCodec* rs,
+	rsWork* ws,	// in: workspace, see rsWorkInit()
+	gfExp* C,	// in: codeword     C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	gfExp* A);	// out: info word   A[k-1] ... A[0]; may be NULL
+// -----------------------------------------------------------------------------
+
+
+// Encode cnt codewords in one call.  Codeword c starts at C + c * stride and
+// holds its information part in the upper k symbols, as in rsDecode():
+//   C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+//   <-- info part -->  <- check part ->
+// The check part is computed in place, so no memory outside the codewords is
+// abused (unlike rsEncode()), and no workspace is needed.
+// -----------------------------------------------------------------------------
+void rsEncodeBatch(
+	const rsCodec* rs,
+	gfExp* C,		// in/out: 1st codeword
+	int stride,		// in: distance between codewords (min: n)
+	int cnt);		// in: number of codewords
+// -----------------------------------------------------------------------------
+
+
+// Decode cnt codewords in one call, like rsDecodeWs() for each.  All
+// codewords are corrected in place.  If A is NULL, no info words are copied
+// out (the corrected info part is C[n-1] ... C[n-k]).
+// status[c] receives the return value of rsDecodeWs() for codeword c.
+// -----------------------------------------------------------------------------
+void rsDecodeBatch(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfExp* C,		// in/out: 1st codeword
+	int stride,		// in: distance between codewords (min: n)
+	gfExp* A,		// out: 1st info word A[k-1] ... A[0]; may be NULL
+	int aStride,	// in: distance between info words (min: k)
+	int cnt,		// in: number of codewords
+	int* status);	// out: status per codeword; may be NULL
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Same functions for symbols in vector representation, as stored in memory or
+// on disk (one byte per symbol for GF_N <= 256, else two).  No conversion of
+// whole codewords to exponent representation is needed.
+// -----------------------------------------------------------------------------
+
+// Compute check symbols from information symbols.
+// Codeword is C = (A, R), A and R may be adjacent or not.
+// -----------------------------------------------------------------------------
+void rsEncodeV(
+	const rsCodec* rs,
+	const gfSym* A,	// in: info word    A[k-1] ... A[0]
+	gfSym* R);		// out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Correct codeword C = (A, R) in place, correcting up to n-k/2 errors in A
+// and R.  A clean codeword is not written at all.
+// Return number of corrected symbols or -1, as rsDecode().
+// -----------------------------------------------------------------------------
+int rsDecodeV(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfSym* A,		// in/out: info part   A[k-1] ... A[0]
+	gfSym* R);		// in/out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Shortened codewords: the highest info symbols of a codeword are left out
+// (they are 0 and neither stored nor processed), so a codec for n symbols
+// serves all lengths nk < n' <= n, chosen per call (e.g. for the last, short
+// piece of a file).  Encoding, syndrome and error search cost as much as for
+// a codec of length n', check symbols are the same as for the info word padded
+// with zeros to the full length.
+// -----------------------------------------------------------------------------
+
+// Compute the nk check symbols of a shortened codeword of n symbols, like
+// rsEncodeV().  The caller ensures nk < n <= rs->n.
+// -----------------------------------------------------------------------------
+void rsEncodeShortV(
+	const rsCodec* rs,
+	int n,			// in: codeword length, nk < n <= rs->n
+	const gfSym* A,	// in: info word    A[k-1] ... A[0], k = n - nk
+	gfSym* R);		// out: check part  R[nk-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Correct a shortened codeword of n symbols in place, like rsDecodeV().
+// Errors are searched at positions 0 ... n-1 only, so an error locator that
+// points into the left out part makes the codeword uncorrectable.
+// Return number of corrected symbols in the info part or -1, also for n out
+// of range.
+// -----------------------------------------------------------------------------
+int rsDecodeShortV(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	int n,			// in: codeword length, nk < n <= rs->n
+	gfSym* A,		// in/out: info part   A[k-1] ... A[0], k = n - nk
+	gfSym* R);		// in/out: check part  R[nk-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Incremental update: when info symbols A[i] change by D = A'[i] - A[i], the
+// check part changes by D * (X^(n-k+i) % rsGen(X)), which is tabulated for
+// every position i ("parity column").  So writing a few symbols costs O(n-k)
+// each instead of re-encoding all k.  The columns don't depend on n, so they
+// are valid for shortened codewords as well.
+// -----------------------------------------------------------------------------
+
+// Tabulate the parity columns (k * (n-k) symbols) for rsUpdate(), freed by
+// rsFree().
+// Return 0 on success, -1 if out of memory.
+// -----------------------------------------------------------------------------
+int rsUpdateInit(rsCodec* rs);
+// -----------------------------------------------------------------------------
+
+
+// Update check part R for info symbols A[i] ... A[i+cnt-1] changing from
+// Aold[0] ... Aold[cnt-1] to Anew[0] ... Anew[cnt-1].  R is the check part of
+// the old codeword, and that of the new one afterwards (for the same errors).
+// The caller ensures 0 <= i, i + cnt <= k.  Needs rsUpdateInit().
+// -----------------------------------------------------------------------------
+void rsUpdate(
+	const rsCodec* rs,
+	int i,				// in: position of the 1st changed info symbol
+	const gfExp* Aold,	// in: old info symbols  Aold[cnt-1] ... Aold[0]
+	const gfExp* Anew,	// in: new info symbols  Anew[cnt-1] ... Anew[0]
+	int cnt,			// in: number of changed info symbols
+	gfExp* R);			// in/out: check part    R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Same in vector representation
+// -----------------------------------------------------------------------------
+void rsUpdateV(
+	const rsCodec* rs,
+	int i,				// in: position of the 1st changed info symbol
+	const gfSym* Aold,	// in: old info symbols  Aold[cnt-1] ... Aold[0]
+	const gfSym* Anew,	// in: new info symbols  Anew[cnt-1] ... Anew[0]
+	int cnt,			// in: number of changed info symbols
+	gfSym* R);			// in/out: check part    R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Verify only (e.g. for scrubbing): only the syndrome is computed, nothing is
+// written, and no workspace is needed, so these are reentrant.  With GFNI,
+// rsCheckBatchV() computes the syndromes of 32 codewords at once, for GF_N
+// <= 256 and one byte per symbol.
+// Return 0 for a clean codeword, 1 for one with errors.
+// -----------------------------------------------------------------------------
+
+// Check codeword C
+// -----------------------------------------------------------------------------
+int rsCheck(
+	const rsCodec* rs,
+	const gfExp* C);	// in: codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+// -----------------------------------------------------------------------------
+
+
+// Check codeword C = (A, R) in vector representation
+// -----------------------------------------------------------------------------
+int rsCheckV(
+	const rsCodec* rs,
+	const gfSym* A,		// in: info part   A[k-1] ... A[0]
+	const gfSym* R);	// in: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Check cnt codewords, laid out as in rsDecodeBatch().
+// Return the number of codewords with errors.
+// -----------------------------------------------------------------------------
+int rsCheckBatch(
+	const rsCodec* rs,
+	const gfExp* C,		// in: 1st codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	int stride,			// in: distance between codewords (min: n)
+	int cnt,			// in: number of codewords
+	int* status);		// out: status per codeword, 0 or 1; may be NULL
+// -----------------------------------------------------------------------------
+
+
+// Same in vector representation: codeword c is A = C + c * stride + n-k,
+// R = C + c * stride (e.g. sectors of n symbols in a buffer).
+// -----------------------------------------------------------------------------
+int rsCheckBatchV(
+	const rsCodec* rs,
+	const gfSym* C,		// in: 1st codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	int stride,			// in: distance between codewords (min: n)
+	int cnt,			// in: number of codewords
+	int* status);		// out: status per codeword, 0 or 1; may be NULL
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Decoder statistics: every decoder function counts into the workspace it is
+// passed (rsDecode() into rs->ws), at the cost of a few increments per
+// codeword.  There is no locking: a snapshot is taken by the thread decoding
+// with the workspace, or while it is idle, and snapshots of several threads
+// are summed with rsStatsAdd().  The mean iterations of the key equation
+// solver (EEA divisions, BM steps) are iter / (decoded - clean).
+// The verify functions (rsCheck() etc.) are not counted.
+// -----------------------------------------------------------------------------
+
+// Copy the statistics of workspace ws to st
+// -----------------------------------------------------------------------------
+void rsStatsGet(
+	const rsWork* ws,	// in: workspace
+	rsStats* st);		// out: snapshot
+// -----------------------------------------------------------------------------
+
+
+// Clear the statistics of workspace ws
+// -----------------------------------------------------------------------------
+void rsStatsReset(rsWork* ws);
+// -----------------------------------------------------------------------------
+
+
+// Add snapshot st to sum
+// -----------------------------------------------------------------------------
+void rsStatsAdd(
+	rsStats* sum,		// in/out: sum
+	const rsStats* st);	// in: snapshot
+// -----------------------------------------------------------------------------
+
+
+// -----------------------------------------------------------------------------
+// Errors-and-erasures decoding: the positions of symbols known to be bad
+// (erasures, e.g. from a failed sector) are passed in, their values don't
+// matter.  Each erasure costs one check symbol instead of two, so e errors
+// and nEra erasures are corrected as long as  2 * e + nEra <= n-k,  i.e. up
+// to n-k erasures alone.  Always uses the Berlekamp-Massey solver.
+// Positions are 0 ... n-1 as in C[i]: info symbol A[j] is at position n-k+j,
+// check symbol R[j] at j.  A position listed more than once counts as one
+// erasure.
+// Return number of corrected symbols in the info part (erased symbols that
+// were right are not counted) or -1, if uncorrectable or if the erasures are
+// invalid (out of range, more than n-k distinct positions).
+// -----------------------------------------------------------------------------
+int rsDecodeEra(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfExp* C,		// in/out: codeword C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+	gfExp* A,		// out: info word   A[k-1] ... A[0]; may be NULL
+	const int* era,	// in: erasure positions (C[era[i]] is bad)
+	int nEra);		// in: number of erasures
+// -----------------------------------------------------------------------------
+
+
+// Same in vector representation, like rsDecodeV()
+// -----------------------------------------------------------------------------
+int rsDecodeEraV(
+	const rsCodec* rs,
+	rsWork* ws,		// in: workspace, see rsWorkInit()
+	gfSym* A,		// in/out: info part   A[k-1] ... A[0]
+	gfSym* R,		// in/out: check part  R[n-k-1] ... R[0]
+	const int* era,	// in: erasure positions, 0 ... n-1 as in rsDecodeEra()
+	int nEra);		// in: number of erasures
+// -----------------------------------------------------------------------------
 #endif	// _RS_H
@@ -0,0 +1,44 @@
+// -----------------------------------------------------------------------------
+// Build-time generator for rs.c: prints rs_tab.h with the generator and super
+// polynomial of the configured code (RS_N_K check symbols, see ecc_cfg.h), so
+// that rsInit() only copies them for this n-k.
+// Built with GF_GEN, see Makefile.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "rs.h"
+
+// -----------------------------------------------------------------------------
+static void printPol(const char* decl, const gfExp* P, int len)
+// -----------------------------------------------------------------------------
+{
+	printf("static const %s = {", decl);
+	for (int i=0; i<len; i++)
+		printf("%s%d,", (i % 16) ? " " : "\n\t", P[i]);
+	printf("\n};\n\n");
+}
+
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	rsCodec rs;
+	if (rsInit(&rs, RS_N, RS_N_K))
+		return 1;
+	printf("// Generated by rs_gen for GF(2^%d), n-k = %d -- do not edit.\n"
+		   "// Included by rs.c only.\n\n", BITS_PER_SYMBOL, RS_N_K);
+	printf("#if (GF_N != %d) || (RS_N_K != %d)\n"
+		   "  #error \"rs_tab.h is for another config, make clean\"\n"
+		   "#endif\n\n", GF_N, RS_N_K);
+	printPol("gfExp rsGenTab[RS_N_K + 1]", rs.gen, RS_N_K + 1);
+	printPol("gfExp rsSupTab[RS_N_K]", rs.sup, RS_N_K);
+	rsFree(&rs);
+	return 0;
+}
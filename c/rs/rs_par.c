@@ -0,0 +1,310 @@
+// -----------------------------------------------------------------------------
+// Parallel Reed-Solomon stripes, see rs_par.h
+//
+// Scheduling: the job's codewords are split into one contiguous share per
+// thread.  The owner takes chunks of par->grain codewords from the front of
+// its share, a thief takes the back half of the largest share of another
+// thread and makes it its own share (which may be stolen from again).  Shares
+// only shrink, so a thread that finds all of them empty is done.  A thief
+// picks its victim from unlocked reads of the shares and locks only that one;
+// lo and hi are therefore stored atomically (relaxed) under the lock.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdlib.h>
+#include <unistd.h>
+#include "rs_par.h"
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+#define RS_PAR_ENC	0	// par->op
+#define RS_PAR_DEC	1
+
+#define RS_PAR_GRAIN	16	// max. codewords per chunk
+
+// relaxed atomic access to the shares, see above:
+#define LOAD(x)			__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define STORE(x, v)		__atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+
+
+// Take the next chunk lo ... hi-1 of the own share.
+// Return 0 if it is empty.
+// -----------------------------------------------------------------------------
+static int rsParTake(
+	const rsPar* par,
+	rsParWorker* w,
+	int* lo,
+	int* hi)
+// -----------------------------------------------------------------------------
+{
+	pthread_mutex_lock(&w->lock);
+	*lo = w->lo;
+	*hi = MIN(w->lo + par->grain, w->hi);
+	STORE(w->lo, *hi);
+	pthread_mutex_unlock(&w->lock);
+	return *hi > *lo;
+}
+
+
+// Steal the back half of the largest share left, keep all but its first chunk
+// lo ... hi-1 as own share.  The own share must be empty.
+// Return 0 if all shares are empty.
+// -----------------------------------------------------------------------------
+static int rsParSteal(
+	const rsPar* par,
+	rsParWorker* w,
+	int* lo,
+	int* hi)
+// -----------------------------------------------------------------------------
+{
+	const int nT = par->nThreads;
+	const int self = w - par->w;
+	for (;;) {
+		rsParWorker* v = NULL;			// victim
+		int most = 0;
+		for (int t=1; t<nT; t++) {
+			rsParWorker* x = par->w + (self + t) % nT;
+			int rem = LOAD(x->hi) - LOAD(x->lo);	// a hint only
+			if (rem > most) {
+				most = rem;
+				v = x;
+			}
+		}
+		if (v == NULL)
+			return 0;
+		pthread_mutex_lock(&v->lock);
+		int rem = v->hi - v->lo;		// may have changed meanwhile
+		if (rem > 0) {
+			*hi = v->hi;
+			*lo = v->hi - (rem + 1) / 2;
+			STORE(v->hi, *lo);
+		}
+		pthread_mutex_unlock(&v->lock);
+		if (rem > 0) {
+			pthread_mutex_lock(&w->lock);
+			STORE(w->lo, MIN(*lo + par->grain, *hi));
+			STORE(w->hi, *hi);
+			pthread_mutex_unlock(&w->lock);
+			*hi = w->lo;
+			return 1;
+		}
+	}
+}
+
+
+// Work on the current job until no codewords are left
+// -----------------------------------------------------------------------------
+static void rsParRun(rsPar* par, rsParWorker* w)
+// -----------------------------------------------------------------------------
+{
+	const rsCodec* rs = par->rs;
+	const int nk = rs->nk;
+	int lo, hi;
+	w->nCorr = 0;
+	w->nFail = 0;
+	while (rsParTake(par, w, &lo, &hi) || rsParSteal(par, w, &lo, &hi)) {
+		gfSym* C = par->buf + (size_t) lo * par->stride;
+		for (int c=lo; c<hi; c++, C+=par->stride) {
+			if (par->op == RS_PAR_ENC) {
+				rsEncodeV(rs, C + nk, C);
+				continue;
+			}
+			int r = rsDecodeV(rs, &w->ws, C + nk, C);
+			if (par->status)
+				par->status[c] = r;
+			if (r < 0)
+				w->nFail++;
+			else
+				w->nCorr += r;
+		}
+	}
+}
+
+
+// Helper thread: wait for a job, run it, report
+// -----------------------------------------------------------------------------
+static void* rsParThread(void* arg)
+// -----------------------------------------------------------------------------
+{
+	rsParWorker* w = arg;
+	rsPar* par = w->par;
+	int gen = 0;						// last job done
+	pthread_mutex_lock(&par->lock);
+	for (;;) {
+		while ((par->gen == gen) && ! par->quit)
+			pthread_cond_wait(&par->go, &par->lock);
+		if (par->quit)
+			break;
+		gen = par->gen;
+		pthread_mutex_unlock(&par->lock);
+		rsParRun(par, w);
+		pthread_mutex_lock(&par->lock);
+		if (--par->busy == 0)
+			pthread_cond_signal(&par->done);
+	}
+	pthread_mutex_unlock(&par->lock);
+	return NULL;
+}
+
+
+// Split job among the threads, run it, wait for the helpers
+// -----------------------------------------------------------------------------
+static void rsParJob(
+	rsPar* par,
+	int op,
+	gfSym* buf,
+	int stride,
+	int cnt,
+	int* status)
+// -----------------------------------------------------------------------------
+{
+	const int nT = par->nThreads;
+	pthread_mutex_lock(&par->lock);
+	par->op = op;
+	par->buf = buf;
+	par->stride = stride;
+	par->cnt = cnt;
+	par->status = status;
+	// small chunks at the end of each share for the balance, but the locks
+	// should not show up:
+	par->grain = cnt / (32 * nT);
+	if (par->grain < 1)
+		par->grain = 1;
+	if (par->grain > RS_PAR_GRAIN)
+		par->grain = RS_PAR_GRAIN;
+	for (int t=0; t<nT; t++) {
+		rsParWorker* w = par->w + t;
+		pthread_mutex_lock(&w->lock);
+		w->lo = (int) ((long long) cnt * t / nT);
+		w->hi = (int) ((long long) cnt * (t + 1) / nT);
+		pthread_mutex_unlock(&w->lock);
+	}
+	par->busy = nT - 1;
+	par->gen++;
+	pthread_cond_broadcast(&par->go);
+	pthread_mutex_unlock(&par->lock);
+
+	rsParRun(par, par->w);				// calling thread is w[0]
+
+	pthread_mutex_lock(&par->lock);
+	while (par->busy > 0)
+		pthread_cond_wait(&par->done, &par->lock);
+	pthread_mutex_unlock(&par->lock);
+}
+
+
+// -----------------------------------------------------------------------------
+int rsParInit(
+	rsPar* par,			// out: pool
+	const rsCodec* rs,	// in: codec
+	int nThreads)		// in: number of threads, or <= 0
+// -----------------------------------------------------------------------------
+{
+	if (nThreads <= 0)
+		nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nThreads <= 0)
+		nThreads = 1;
+	const int wsSize = (rsWorkSize(rs) + 63) & ~63;
+	par->rs = rs;
+	par->nThreads = 0;					// threads started, for rsParFree()
+	par->w = calloc(nThreads, sizeof(rsParWorker));
+	par->mem = malloc((size_t) nThreads * wsSize);
+	pthread_mutex_init(&par->lock, NULL);
+	pthread_cond_init(&par->go, NULL);
+	pthread_cond_init(&par->done, NULL);
+	par->gen = 0;
+	par->busy = 0;
+	par->quit = 0;
+	if ((par->w == NULL) || (par->mem == NULL)) {
+		rsParFree(par);
+		return -1;
+	}
+	for (int t=0; t<nThreads; t++) {
+		rsParWorker* w = par->w + t;
+		pthread_mutex_init(&w->lock, NULL);
+		rsWorkInit(rs, &w->ws, (char*) par->mem + (size_t) t * wsSize);
+		w->par = par;
+		par->nThreads++;
+		if ((t > 0) && pthread_create(&w->th, NULL, rsParThread, w)) {
+			pthread_mutex_destroy(&w->lock);
+			par->nThreads--;
+			rsParFree(par);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+void rsParFree(rsPar* par)
+// -----------------------------------------------------------------------------
+{
+	pthread_mutex_lock(&par->lock);
+	par->quit = 1;
+	pthread_cond_broadcast(&par->go);
+	pthread_mutex_unlock(&par->lock);
+	for (int t=0; t<par->nThreads; t++) {
+		if (t > 0)
+			pthread_join(par->w[t].th, NULL);
+		pthread_mutex_destroy(&par->w[t].lock);
+	}
+	pthread_cond_destroy(&par->done);
+	pthread_cond_destroy(&par->go);
+	pthread_mutex_destroy(&par->lock);
+	free(par->mem);
+	free(par->w);
+	par->mem = NULL;
+	par->w = NULL;
+	par->nThreads = 0;
+}
+
+
+// -----------------------------------------------------------------------------
+void rsParEncode(
+	rsPar* par,
+	gfSym* buf,		// in/out: 1st codeword
+	int stride,		// in: distance between codewords (min: n)
+	int cnt)		// in: number of codewords
+// -----------------------------------------------------------------------------
+{
+	rsParJob(par, RS_PAR_ENC, buf, stride, cnt, NULL);
+}
+
+
+// -----------------------------------------------------------------------------
+int rsParDecode(
+	rsPar* par,
+	gfSym* buf,		// in/out: 1st codeword
+	int stride,		// in: distance between codewords (min: n)
+	int cnt,		// in: number of codewords
+	int* status)	// out: status per codeword; may be NULL
+// -----------------------------------------------------------------------------
+{
+	rsParJob(par, RS_PAR_DEC, buf, stride, cnt, status);
+	int nCorr = 0, nFail = 0;
+	for (int t=0; t<par->nThreads; t++) {
+		nCorr += par->w[t].nCorr;
+		nFail += par->w[t].nFail;
+	}
+	return nFail ? -1 : nCorr;
+}
+
+
+// -----------------------------------------------------------------------------
+void rsParStats(
+	const rsPar* par,
+	rsStats* st)	// out: sum of the statistics of all threads
+// -----------------------------------------------------------------------------
+{
+	rsStats zero = {0};
+	*st = zero;
+	for (int t=0; t<par->nThreads; t++)
+		rsStatsAdd(st, &par->w[t].ws.st);
+}
@@ -0,0 +1,113 @@
+// -----------------------------------------------------------------------------
+// Parallel Reed-Solomon stripes: encode or decode a large buffer of codewords
+// with a pool of threads.
+//
+// The buffer is split evenly among the threads, and each thread works through
+// its share in small chunks.  A thread that runs out of work steals the back
+// half of the largest share left, so codewords with many errors (expensive to
+// decode) don't leave the other threads idle.  Each thread has its own decoder
+// workspace, the codec itself is shared.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#ifndef _RS_PAR_H
+#define _RS_PAR_H
+
+#include <pthread.h>
+#include <rs/rs.h>
+
+// Per-thread state.  Padded to keep the locks of neighbours apart.
+typedef struct {
+	pthread_mutex_t lock;	// protects lo, hi
+	int		lo;		// remaining codewords of this thread: lo ... hi-1
+	int		hi;
+	int		nCorr;	// corrected info symbols (current job)
+	int		nFail;	// uncorrectable codewords (current job)
+	rsWork	ws;		// decoder workspace
+	struct rsPar* par;
+	pthread_t th;
+	char	pad[64];
+} rsParWorker;
+
+// Thread pool.  Members are read-only for the user.
+typedef struct rsPar {
+	const rsCodec* rs;
+	int		nThreads;	// incl. the calling thread
+	rsParWorker* w;		// nThreads workers, w[0] is the calling thread
+	void*	mem;		// workspaces
+	pthread_mutex_t lock;
+	pthread_cond_t go;	// new job or quit
+	pthread_cond_t done;// all helper threads finished the job
+	int		gen;		// job counter
+	int		busy;		// helper threads still working on the job
+	int		quit;
+	// current job:
+	int		op;
+	gfSym*	buf;
+	int		stride;
+	int		cnt;
+	int*	status;
+	int		grain;		// codewords per chunk
+} rsPar;
+
+
+// Start pool for codec rs (which must outlive it) with nThreads threads, the
+// calling thread included.  nThreads <= 0 means one per online CPU.
+// Return 0 on success, -1 if out of memory or threads.
+// -----------------------------------------------------------------------------
+int rsParInit(
+	rsPar* par,			// out: pool
+	const rsCodec* rs,	// in: codec
+	int nThreads);		// in: number of threads, or <= 0
+// -----------------------------------------------------------------------------
+
+
+// Stop threads and free memory of rsParInit()
+// -----------------------------------------------------------------------------
+void rsParFree(rsPar* par);
+// -----------------------------------------------------------------------------
+
+
+// Encode cnt codewords in vector representation, like rsEncodeV() for each.
+// Codeword c starts at buf + c * stride, laid out as C in rsEncodeBatch():
+//   C[n-1] ... C[n-k] C[n-k-1] ... C[0]
+//   <-- info part -->  <- check part ->
+// so the check part comes first in memory: R = C, A = C + n-k.
+// Returns when all codewords are done.  Not reentrant for the same pool.
+// -----------------------------------------------------------------------------
+void rsParEncode(
+	rsPar* par,
+	gfSym* buf,		// in/out: 1st codeword
+	int stride,		// in: distance between codewords (min: n)
+	int cnt);		// in: number of codewords
+// -----------------------------------------------------------------------------
+
+
+// Decode cnt codewords in place, like rsDecodeV() for each, layout as in
+// rsParEncode().  status[c] receives the return value of rsDecodeV() for
+// codeword c.
+// Return number of corrected info symbols, or -1 if any codeword was
+// uncorrectable (the others are corrected anyway).
+// -----------------------------------------------------------------------------
+int rsParDecode(
+	rsPar* par,
+	gfSym* buf,		// in/out: 1st codeword
+	int stride,		// in: distance between codewords (min: n)
+	int cnt,		// in: number of codewords
+	int* status);	// out: status per codeword; may be NULL
+// -----------------------------------------------------------------------------
+
+
+// Sum the decoder statistics of all threads of the pool (see rsStatsGet()),
+// counted since rsParInit().  Call it between jobs.
+// -----------------------------------------------------------------------------
+void rsParStats(
+	const rsPar* par,
+	rsStats* st);	// out: sum of the statistics of all threads
+// -----------------------------------------------------------------------------
+#endif	// _RS_PAR_H
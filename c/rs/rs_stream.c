@@ -0,0 +1,261 @@
+// -----------------------------------------------------------------------------
+// Interleaved Reed-Solomon streams, see rs_stream.h
+//
+// The encoder runs the shift register of rsEncodeV() for all D codewords of
+// a block side by side: the registers are n-k rows of D symbols, and a row of
+// the stream updates all of them with one region operation per generator
+// coeff.  The rows form a ring, so shifting is just moving its base.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "rs_stream.h"
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+
+// -----------------------------------------------------------------------------
+int rsStreamInit(
+	rsStream* st,		// out: stream
+	const rsCodec* rs,	// in: codec
+	int D)				// in: interleave depth, min. 1
+// -----------------------------------------------------------------------------
+{
+	if (D < 1)
+		return -1;
+	st->rs = rs;
+	st->D = D;
+	st->m = 0;
+	st->base = 0;
+	st->P = calloc((rs->nk + 1) * D, sizeof(gfSym));
+	if (st->P == NULL)
+		return -1;
+	st->fb = st->P + rs->nk * D;
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+void rsStreamFree(rsStream* st)
+// -----------------------------------------------------------------------------
+{
+	free(st->P);
+	st->P = NULL;
+}
+
+
+// -----------------------------------------------------------------------------
+int rsStreamEncSize(const rsStream* st, int len)
+// -----------------------------------------------------------------------------
+{
+	const int kD = st->rs->k * st->D;
+	return len + (st->m + len) / kD * st->rs->nk * st->D;
+}
+
+
+// One symbol s of codeword c into the shift register, whose rows start at
+// ring row b afterwards (one before the current base):
+//   fb = s + R[n-k-1],  R[i] = R[i-1] - fb * gen[i]
+// R[n-k-1] is at ring row b, where the new R[0] goes.
+// -----------------------------------------------------------------------------
+static void rsStreamSym(
+	rsStream* st,
+	int c,				// in: codeword (lane)
+	gfSym s,			// in: info symbol
+	int b)				// in: new base
+// -----------------------------------------------------------------------------
+{
+	const int D = st->D, nk = st->rs->nk;
+	const gfExp* gen = st->rs->gen;
+	gfSym* P = st->P + c;
+	gfVec fb = s ^ P[b * D];
+	P[b * D] = GF_0;
+	if (fb == GF_0)
+		return;
+	gfExp q = gfV2E[fb];
+	for (int i=0, r=b; i<nk; i++, r++) {		// gen[i] != 0, see rsInit()
+		if (r == nk)
+			r = 0;
+		P[r * D] ^= gfE2V[gfMul11(q, gen[i])];
+	}
+}
+
+
+// Same for a whole row of D symbols (one per codeword)
+// -----------------------------------------------------------------------------
+static void rsStreamRow(
+	rsStream* st,
+	const gfSym* row,	// in: D info symbols
+	int b)				// in: new base
+// -----------------------------------------------------------------------------
+{
+	const int D = st->D, nk = st->rs->nk;
+	const gfExp* gen = st->rs->gen;
+	gfSym* top = st->P + b * D;
+	gfSym* fb = st->fb;
+	for (int c=0; c<D; c++) {
+		fb[c] = row[c] ^ top[c];
+		top[c] = GF_0;
+	}
+	for (int i=0, r=b; i<nk; i++, r++) {
+		if (r == nk)
+			r = 0;
+		gfSym* Pr = st->P + r * D;
+  #if (GF_N <= 256)
+		gfRegionMulAdd(Pr, fb, gen[i], D);
+  #else
+		for (int c=0; c<D; c++)
+			Pr[c] ^= gfE2V[gfMul01(gfV2E[fb[c]], gen[i])];
+  #endif
+	}
+}
+
+
+// Write the parity rows of the current block and reset the registers.
+// Codewords c < m % D have got one symbol more than the others, their
+// registers start one row before the base.
+// Return number of symbols written.
+// -----------------------------------------------------------------------------
+static int rsStreamParity(
+	rsStream* st,
+	gfSym* out)
+// -----------------------------------------------------------------------------
+{
+	const int D = st->D, nk = st->rs->nk;
+	const int nD = MIN(D, st->m);			// codewords in the block
+	const int split = st->m % D;
+	for (int c=0; c<nD; c++) {
+		int b = st->base;
+		if (c < split)
+			b = (b == 0) ? nk - 1 : b - 1;
+		gfSym* o = out + (c - split + nD) % nD;	// continue the cyclic order
+		for (int j=nk-1; j>=0; j--, o+=nD) {	// R[n-k-1] first
+			int r = b + j;
+			if (r >= nk)
+				r -= nk;
+			*o = st->P[r * D + c];
+		}
+	}
+	for (int i=nk*D-1; i>=0; i--)
+		st->P[i] = GF_0;
+	st->m = 0;
+	st->base = 0;
+	return nk * nD;
+}
+
+
+// -----------------------------------------------------------------------------
+int rsStreamEnc(
+	rsStream* st,		// in/out: stream
+	const gfSym* in,	// in: next piece of the stream
+	int len,			// in: its length, any
+	gfSym* out)			// out: rsStreamEncSize(st, len) symbols max.
+// -----------------------------------------------------------------------------
+{
+	const int D = st->D, nk = st->rs->nk, kD = st->rs->k * D;
+	gfSym* out0 = out;
+	while (len > 0) {
+		int c = st->m % D;					// codeword of the next symbol
+		int b = (st->base == 0) ? nk - 1 : st->base - 1;
+		if ((c == 0) && (len >= D)) {
+			// whole rows, up to the end of the block:
+			int rows = MIN(len / D, (kD - st->m) / D);
+			for (int r=0; r<rows; r++) {
+				for (int i=0; i<D; i++)
+					out[i] = in[i];
+				rsStreamRow(st, out, b);
+				st->base = b;
+				b = (b == 0) ? nk - 1 : b - 1;
+				in += D;
+				out += D;
+			}
+			len -= rows * D;
+			st->m += rows * D;
+		} else {
+			// single symbols, e.g. at the start/end of a piece:
+			*out++ = *in;
+			rsStreamSym(st, c, *in++, b);
+			len--;
+			st->m++;
+			if (st->m % D == 0)
+				st->base = b;
+		}
+		if (st->m == kD)
+			out += rsStreamParity(st, out);
+	}
+	return out - out0;
+}
+
+
+// -----------------------------------------------------------------------------
+int rsStreamEncEnd(
+	rsStream* st,		// in/out: stream
+	gfSym* out)			// out: parity rows
+// -----------------------------------------------------------------------------
+{
+	if (st->m == 0)
+		return 0;
+	return rsStreamParity(st, out);
+}
+
+
+// -----------------------------------------------------------------------------
+int rsStreamDecBlock(
+	const rsStream* st,	// in: stream (only rs and D are used)
+	rsWork* ws,			// in: workspace, see rsWorkInit()
+	gfSym* blk,			// in/out: block
+	int len,			// in: block length
+	int* nCorr)			// out: corrected info symbols, may be NULL
+// -----------------------------------------------------------------------------
+{
+	const rsCodec* rs = st->rs;
+	const int D = st->D, n = rs->n, nk = rs->nk, k = rs->k;
+	// info symbols m from len = m + nk * min(D, m):
+	int m = len - nk * D;
+	if ((m < D) || (m > k * D)) {
+		m = len / (nk + 1);
+		if ((m <= 0) || (m >= D) || (m * (nk + 1) != len))
+			return -1;
+	}
+	const int nD = MIN(D, m);
+	const gfSym* Rb = blk + m;				// parity rows
+	gfSym W[n];								// one codeword, gathered
+	gfSym* A = W + nk;
+	int ret = m;
+	if (nCorr)
+		*nCorr = 0;
+	for (int c=0; c<nD; c++) {
+		// shortened codeword: leading info symbols are 0:
+		const int kc = m / D + (c < m % D);
+		const int off = (c - m % nD + nD) % nD;	// 1st parity symbol
+		for (int i=k-1; i>=kc; i--)
+			A[i] = GF_0;
+		for (int r=0; r<kc; r++)
+			A[kc - 1 - r] = blk[r * D + c];
+		for (int j=0; j<nk; j++)
+			W[nk - 1 - j] = Rb[j * nD + off];
+		int nc = rsDecodeV(rs, ws, A, W);
+		for (int i=k-1; i>=kc; i--)
+			if (A[i] != GF_0)				// "corrected" a missing symbol
+				nc = -1;
+		if (nc < 0) {
+			ret = -1;
+			continue;
+		}
+		// write back changed symbols only:
+		for (int r=0; r<kc; r++)
+			if (blk[r * D + c] != A[kc - 1 - r])
+				blk[r * D + c] = A[kc - 1 - r];
+		for (int j=0; j<nk; j++)
+			if (Rb[j * nD + off] != W[nk - 1 - j])
+				blk[m + j * nD + off] = W[nk - 1 - j];
+		if (nCorr)
+			*nCorr += nc;
+	}
+	return ret;
+}
@@ -0,0 +1,100 @@
+// -----------------------------------------------------------------------------
+// Interleaved Reed-Solomon streams: encode a symbol stream of any length,
+// given in pieces of any length, into blocks of D interleaved codewords.
+//
+// Block layout (D = interleave depth, symbols in stream order):
+//   info:    k rows of D symbols, symbol t goes to codeword t % D
+//   parity:  n-k rows of D symbols, row j holds check symbol R[n-k-1-j] of
+//            all D codewords
+// So info symbols are passed through unchanged, and a burst of up to
+// D * (n-k)/2 symbols hits each codeword at most (n-k)/2 times.
+// The final block is shortened: with m < k*D info symbols, it has only
+// D' = min(D, m) codewords, codeword c gets m/D info symbols (+1 for c < m%D),
+// and the parity rows have D' symbols.  Its length is  m + (n-k) * D'.
+// The parity symbols continue the cyclic order of the codewords after the
+// last info symbol (parity symbol u belongs to codeword (m+u) % D'), so the
+// burst limit holds across the ragged last info row, too.
+//
+// Symbols are in vector representation (gfSym, i.e. bytes for GF(2^8)).
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#ifndef _RS_STREAM_H
+#define _RS_STREAM_H
+
+#include <rs/rs.h>
+
+// Stream context (encoder state).  Members are read-only for the user.
+typedef struct {
+	const rsCodec* rs;
+	int		D;		// interleave depth (codewords per block)
+	int		m;		// info symbols of the current block so far
+	int		base;	// ring row of check symbol R[0] of the parity shift registers
+	gfSym*	P;		// parity shift registers: n-k rows of D symbols (a ring)
+	gfSym*	fb;		// feedback of one row
+} rsStream;
+
+
+// Initialize stream for codec rs (which must outlive it) and depth D.
+// Return 0 on success, -1 on invalid parameters or if out of memory.
+// -----------------------------------------------------------------------------
+int rsStreamInit(
+	rsStream* st,		// out: stream
+	const rsCodec* rs,	// in: codec
+	int D);				// in: interleave depth, min. 1
+// -----------------------------------------------------------------------------
+
+
+// Free memory allocated by rsStreamInit()
+// -----------------------------------------------------------------------------
+void rsStreamFree(rsStream* st);
+// -----------------------------------------------------------------------------
+
+
+// Return max. number of symbols written by rsStreamEnc() for len symbols
+// -----------------------------------------------------------------------------
+int rsStreamEncSize(const rsStream* st, int len);
+// -----------------------------------------------------------------------------
+
+
+// Encode the next len symbols of the stream.  They are copied to out (the
+// only copy made), followed by the parity rows of each block completed.
+// Return number of symbols written to out.
+// -----------------------------------------------------------------------------
+int rsStreamEnc(
+	rsStream* st,		// in/out: stream
+	const gfSym* in,	// in: next piece of the stream
+	int len,			// in: its length, any
+	gfSym* out);		// out: rsStreamEncSize(st, len) symbols max.
+// -----------------------------------------------------------------------------
+
+
+// End of stream: write the parity rows of the final (shortened) block, if
+// any.  The stream can then be used for the next one.
+// Return number of symbols written to out, max. (n-k) * D.
+// -----------------------------------------------------------------------------
+int rsStreamEncEnd(
+	rsStream* st,		// in/out: stream
+	gfSym* out);		// out: parity rows
+// -----------------------------------------------------------------------------
+
+
+// Decode one block in place, as written by the encoder: n * D symbols, or
+// less for the final block.  The info symbols stay at the start of the block,
+// so nothing is copied.  Only codewords with a non-zero syndrome are touched.
+// Return number of info symbols in the block, or -1 if len is no valid block
+// length or any codeword was uncorrectable (the others are corrected).
+// -----------------------------------------------------------------------------
+int rsStreamDecBlock(
+	const rsStream* st,	// in: stream (only rs and D are used)
+	rsWork* ws,			// in: workspace, see rsWorkInit()
+	gfSym* blk,			// in/out: block
+	int len,			// in: block length
+	int* nCorr);		// out: corrected info symbols, may be NULL
+// -----------------------------------------------------------------------------
+#endif	// _RS_STREAM_H
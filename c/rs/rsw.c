@@ -0,0 +1,167 @@
+// -----------------------------------------------------------------------------
+// Reed-Solomon codes over the wide fields, see rsw.h
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include "rsw.h"
+
+
+// -----------------------------------------------------------------------------
+int rswInit(
+	rswCodec* rs,	// out: codec
+	size_t n,		// in: codeword length, 1 < n <= GFW_ORDER
+	int nk)			// in: number of check symbols, 0 < nk < n, nk <= RSW_MAX_NK
+// -----------------------------------------------------------------------------
+{
+	if ((n > GFW_ORDER) || (nk <= 0) || ((size_t) nk >= n) || (nk > RSW_MAX_NK))
+		return -1;
+	rs->n = n;
+	rs->nk = nk;
+	rs->k = n - nk;
+	// generator polynomial and syndrome table in one block:
+	rs->gen = malloc((nk + 1 + (GFW_BLOCK + 1) * nk) * sizeof(gfw));
+	if (rs->gen == NULL)
+		return -1;
+	rs->synTab = rs->gen + nk + 1;
+
+	// rsGen(X) = prod(X - z^i), i = 1 ... n-k, highest coeff. at gen[nk]:
+	gfw* gen = rs->gen;
+	gen[0] = GFW_1;
+	gfw zi = GFW_1;
+	for (int i=1; i<=nk; i++) {
+		zi = gfwMul(zi, GFW_Z);
+		gen[i] = gen[i-1];
+		for (int j=i-1; j>0; j--)
+			gen[j] = gen[j-1] ^ gfwMul(gen[j], zi);
+		gen[0] = gfwMul(gen[0], zi);
+	}
+	// syndrome Y[nk-1-j] = C(z^(j+1)):
+	gfwPolEvalTab(rs->synTab, nk - 1, GFW_Z);
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+void rswFree(rswCodec* rs)
+// -----------------------------------------------------------------------------
+{
+	free(rs->gen);
+	rs->gen = NULL;
+}
+
+
+// -----------------------------------------------------------------------------
+void rswEncode(
+	const rswCodec* rs,
+	const gfw* A,	// in: info word    A[k-1] ... A[0]
+	gfw* R)			// out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	gfwPolRem(A, rs->k - 1, rs->gen, rs->nk, R);
+}
+
+
+// Berlekamp-Massey algorithm: error locator L from the syndrome
+// S[j] = C(z^(j+1)), j = 0 ... nk-1.
+// Return deg(L).
+// -----------------------------------------------------------------------------
+static int rswBM(
+	const gfw* S,
+	int nk,
+	gfw* L)		// out: L[nk] ... L[0]
+// -----------------------------------------------------------------------------
+{
+	gfw B[nk + 1], T[nk + 1];
+	for (int i=0; i<=nk; i++)
+		L[i] = B[i] = GFW_0;
+	L[0] = B[0] = GFW_1;
+	int nL = 0, m = 1;
+	gfw b = GFW_1;
+	for (int r=0; r<nk; r++) {
+		gfw d = S[r];						// discrepancy
+		for (int i=1; (i <= nL) && (i <= r); i++)
+			d ^= gfwMul(L[i], S[r - i]);
+		if (d == GFW_0) {
+			m++;
+			continue;
+		}
+		gfw c = gfwMul(d, gfwInv(b));
+		int grow = 2 * nL <= r;
+		if (grow)
+			for (int i=0; i<=nk; i++)
+				T[i] = L[i];
+		for (int i=0; i+m<=nk; i++)			// L -= c * X^m * B
+			L[i + m] ^= gfwMul(c, B[i]);
+		if (grow) {
+			nL = r + 1 - nL;
+			for (int i=0; i<=nk; i++)
+				B[i] = T[i];
+			b = d;
+			m = 1;
+		} else
+			m++;
+	}
+	return nL;
+}
+
+
+// Syndrome, Berlekamp-Massey, Chien search, Forney
+// -----------------------------------------------------------------------------
+int rswDecode(
+	const rswCodec* rs,
+	gfw* A,			// in/out: info part   A[k-1] ... A[0]
+	gfw* R)			// in/out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk;
+	gfw Y[nk], S[nk], L[nk + 1], W[nk];
+	for (int j=0; j<nk; j++)
+		Y[j] = GFW_0;
+	gfwPolEvalSeq(A, rs->k - 1, Y, nk - 1, rs->synTab);
+	if (! gfwPolEvalSeq(R, nk - 1, Y, nk - 1, rs->synTab))
+		return 0;
+	for (int j=0; j<nk; j++)
+		S[j] = Y[nk - 1 - j];				// C(z^(j+1))
+
+	int nL = rswBM(S, nk, L);
+	if (2 * nL > nk)
+		return -1;
+	size_t X[nL + 1];						// error locations
+	if (gfwPolRoots(L, nL, rs->n, X, nL) != nL)
+		return -1;
+
+	// evaluator W = S * L mod X^nk, error value W(X^-1) / L'(X^-1):
+	for (int i=0; i<nk; i++) {
+		W[i] = GFW_0;
+		for (int j=0; (j <= i) && (j <= nL); j++)
+			W[i] ^= gfwMul(L[j], S[i - j]);
+	}
+	gfw D[nL + 1];							// L' (odd coeffs only)
+	for (int i=0; i<nL; i++)
+		D[i] = (i & 1) ? GFW_0 : L[i + 1];
+	const gfw zi = gfwInv(GFW_Z);
+	gfw V[nL + 1];							// error values
+	for (int e=0; e<nL; e++) {
+		gfw x = gfwPow(zi, X[e]);
+		gfw d = gfwPolEval(D, nL - 1, x);
+		if (d == GFW_0)
+			return -1;
+		V[e] = gfwMul(gfwPolEval(W, nk - 1, x), gfwInv(d));
+	}
+	int nCorr = 0;
+	for (int e=0; e<nL; e++) {
+		if (X[e] < (size_t) nk)
+			R[X[e]] ^= V[e];
+		else {
+			A[X[e] - nk] ^= V[e];
+			nCorr++;
+		}
+	}
+	return nCorr;
+}
@@ -0,0 +1,71 @@
+// -----------------------------------------------------------------------------
+// Reed-Solomon codes over the wide fields GF(2^24), GF(2^32) (see gf/gfw.h),
+// for very long codewords: up to 2^GFW_BITS - 1 symbols of 32 bits.
+//
+// Same code as rs.h (narrow-sense, rsGen(X) = prod(X - z^i), i = 1 ... n-k),
+// but all in vector representation, without lookup tables.  The decoder
+// uses Berlekamp-Massey, a blocked Chien search and Forney's formula; its
+// memory (on the stack) grows with n-k only, not with n, and it is
+// reentrant, so several threads may use one codec.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#ifndef _RSW_H
+#define _RSW_H
+
+#include <gf/gfw.h>
+
+// max. number of check symbols (stack use of the decoder)
+#define RSW_MAX_NK	4096
+
+// Codec context.  Members are read-only for the user.
+typedef struct {
+	size_t	n;		// codeword length (info + check part), n <= GFW_ORDER
+	int		nk;		// number of check symbols n-k
+	size_t	k;		// number of information symbols
+	gfw*	gen;	// generator polynomial without highest coeff = 1
+	gfw*	synTab;	// table to compute the syndrome, see gfwPolEvalTab()
+} rswCodec;
+
+
+// Initialize codec for an (n, k) code with nk = n-k check symbols.
+// Return 0 on success, -1 on invalid parameters or if out of memory.
+// -----------------------------------------------------------------------------
+int rswInit(
+	rswCodec* rs,	// out: codec
+	size_t n,		// in: codeword length, 1 < n <= GFW_ORDER
+	int nk);		// in: number of check symbols, 0 < nk < n, nk <= RSW_MAX_NK
+// -----------------------------------------------------------------------------
+
+
+// Free memory allocated by rswInit()
+// -----------------------------------------------------------------------------
+void rswFree(rswCodec* rs);
+// -----------------------------------------------------------------------------
+
+
+// Compute check symbols from information symbols, like rsEncodeV()
+// -----------------------------------------------------------------------------
+void rswEncode(
+	const rswCodec* rs,
+	const gfw* A,	// in: info word    A[k-1] ... A[0]
+	gfw* R);		// out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+
+
+// Correct codeword C = (A, R) in place, like rsDecodeV(): errors in the check
+// part are corrected too.
+// Return number of corrected symbols in the information part or -1, if the
+// codeword was detected to be uncorrectable.
+// -----------------------------------------------------------------------------
+int rswDecode(
+	const rswCodec* rs,
+	gfw* A,			// in/out: info part   A[k-1] ... A[0]
+	gfw* R);		// in/out: check part  R[n-k-1] ... R[0]
+// -----------------------------------------------------------------------------
+#endif	// _RSW_H
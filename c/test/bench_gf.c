@@ -0,0 +1,144 @@
+// -----------------------------------------------------------------------------
+// Micro benchmark for gf.c: basic operations with random operands (i.e. random
+// table accesses) in exponent and vector representation and polynomial
+// kernels, together with the memory footprint of tables and data.  Build with
+// different BITS_PER_SYMBOL, with/without GF_INT_SYMBOLS and with different
+// GF_ARITH back-ends to compare (see "make bench_types", "make bench_arith").
+//
+// Output is CSV, one line per kernel:
+//   bits,sym_bytes,table_bytes,arith,kernel,ns_per_op
+// Option -H omits the header line.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "test_util.h"
+#include <gf/gf.h>
+
+#define N_OPS	(1 << 22)	// operands for the basic operations
+#define N_POL	1023		// max. degree for polynomial kernels
+#define N_Y		31			// number of locations - 1 for gfPolEvalSeq()
+
+static gfExp X[N_OPS];		// random operands, 1/2/4 MB
+static gfExp Y[N_OPS];
+static gfVec Yv[N_POL + 1];
+static gfExp A[N_POL + 1];
+static gfExp B[N_POL + 1];
+static gfExp C[2 * N_POL + 1];
+
+#if (GF_ARITH == GF_ARITH_ZECH)
+  #define ARITH		"zech"
+  #define ARITH_TAB	sizeof(zechLog)
+#elif (GF_ARITH == GF_ARITH_TAB)
+  #define ARITH		"tab"
+  #define ARITH_TAB	sizeof(gfMulTab)
+#else
+  #define ARITH		"log"
+  #define ARITH_TAB	0
+#endif
+
+volatile int sink;			// keeps results alive
+
+
+// -----------------------------------------------------------------------------
+static void report(const char* kernel, double t, double ops)
+// -----------------------------------------------------------------------------
+{
+	printf("%d,%d,%d,%s,%s,%.3f\n", BITS_PER_SYMBOL, (int) sizeof(gfExp),
+		   (int) (sizeof(gfE2V) + sizeof(gfV2E) + ARITH_TAB), ARITH, kernel,
+		   1e9 * t / ops);
+}
+
+
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+// -----------------------------------------------------------------------------
+{
+	gfInit();
+	if ((argc < 2) || strcmp(argv[1], "-H"))
+		printf("bits,sym_bytes,table_bytes,arith,kernel,ns_per_op\n");
+
+	for (int i=0; i<N_OPS; i++) {
+		X[i] = randE();
+		Y[i] = randE();
+	}
+
+	// ---------- basic operations ----------
+	double t = timeNow();
+	gfExp r = GF_1;
+	for (int i=0; i<N_OPS; i++)			// dependent chain: latency incl. table misses
+		r = gfAdd(r, X[i]);
+	sink = r;
+	report("gfAdd_chain", timeNow() - t, N_OPS);
+
+	t = timeNow();
+	for (int i=0; i<N_OPS; i++)			// independent: throughput
+		Y[i] = gfAdd(X[i], Y[i]);
+	report("gfAdd", timeNow() - t, N_OPS);
+
+	t = timeNow();
+	for (int i=0; i<N_OPS; i++)
+		Y[i] = gfMul(X[i], Y[i]);
+	report("gfMul", timeNow() - t, N_OPS);
+
+	t = timeNow();
+	for (int i=0; i<N_OPS; i++)
+		Y[i] = gfDiv(Y[i], X[i] | 1);	// divisor != 0
+	report("gfDiv", timeNow() - t, N_OPS);
+
+	// same in vector repr. (operands are valid either way):
+	t = timeNow();
+	for (int i=0; i<N_OPS; i++)
+		Y[i] = gfMulV(X[i], Y[i]);
+	report("gfMulV", timeNow() - t, N_OPS);
+
+	t = timeNow();
+	for (int i=0; i<N_OPS; i++)
+		Y[i] = gfDivV(Y[i], X[i] | 1);	// divisor != 0
+	report("gfDivV", timeNow() - t, N_OPS);
+
+	// ---------- polynomial kernels ----------
+	int nA = N_POL;
+	if (nA > GF_N - 2)					// limit of gfPolEvalSeq()
+		nA = GF_N - 2;
+	randPol(A, nA);
+	A[nA] = GF_1;
+	randPol(B, nA);
+	B[nA] = GF_1;
+	int runs = 2000000 / (nA + 1);
+
+	t = timeNow();
+	for (int i=0; i<runs; i++)
+		gfPolEvalSeq(A, nA, Yv, N_Y, GF_Z(1 + i % 8));
+	sink = Yv[0];
+	report("gfPolEvalSeq/coeff", timeNow() - t, (double) runs * (nA + 1));
+
+#if (GF_N <= 256)
+	static uint8_t T[(N_POL + 1) * GF_SEQ_ROW(N_Y)];
+	gfPolEvalSeqTab(T, nA, N_Y, GF_Z(1));
+	t = timeNow();
+	for (int i=0; i<runs; i++)
+		gfPolEvalSeqT(A, nA, Yv, N_Y, T);
+	sink = Yv[0];
+	report("gfPolEvalSeqT/coeff", timeNow() - t, (double) runs * (nA + 1));
+#endif
+
+	t = timeNow();
+	for (int i=0; i<runs; i++)
+		sink = gfPolEval(A, nA, GF_Z(1 + i % 8));
+	report("gfPolEval/coeff", timeNow() - t, (double) runs * (nA + 1));
+
+	runs = runs / (nA + 1) + 1;
+	t = timeNow();
+	for (int i=0; i<runs; i++)
+		sink = gfPolMul(A, nA, B, nA, C);
+	report("gfPolMul/coeff^2", timeNow() - t, (double) runs * (nA + 1) * (nA + 1));
+
+	return 0;
+}
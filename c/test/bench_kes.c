@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------
+// Benchmark for the key equation solvers of rsDecode(): the extended Euclidean
+// algorithm (RS_KES_EEA) vs. inversionless Berlekamp-Massey (RS_KES_BM).
+// Decodes the same corrupted codewords with both solvers for several n-k and
+// numbers of errors.  Syndrome and error search are the same for both, so the
+// difference is the solver.
+//
+// Output is CSV, one line per (n-k, errors, solver):
+//   bits,n,nk,errors,solver,ns_per_decode
+// Option -H omits the header line.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "test_util.h"
+#include <rs/rs.h>
+#include <gf/gf.h>
+
+#define POOL	32				// number of different codewords
+#define DECODES	2000000			// decodes per measurement (* 64 / (n * nk))
+
+static gfExp pool[POOL][GF_N];	// codewords with errors
+static gfExp C[GF_N];
+static gfExp A[GF_N];
+
+volatile int sink;				// keeps results alive
+
+
+// -----------------------------------------------------------------------------
+static void bench(rsCodec* rs, int nErrs)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk;
+	// codewords with exactly nErrs errors at distinct locations:
+	for (int p=0; p<POOL; p++) {
+		gfExp* W = pool[p];
+		for (int i=nk; i<n; i++)
+			W[i] = randE();
+		rsEncodeBatch(rs, W, GF_N, 1);
+		char hit[GF_N] = {0};
+		for (int e=0; e<nErrs; e++) {
+			int loc;
+			do {
+				loc = rand(0, n - 1);
+			} while (hit[loc]);
+			hit[loc] = 1;
+			W[loc] = gfAdd(W[loc], randE1());
+		}
+	}
+	int runs = DECODES * 64 / (n * nk) + POOL;
+	static const char* name[] = {"EEA", "BM"};
+	for (int kes=RS_KES_EEA; kes<=RS_KES_BM; kes++) {
+		rs->kes = kes;
+		double t = timeNow();
+		for (int r=0; r<runs; r++) {
+			memcpy(C, pool[r % POOL], n * sizeof(gfExp));
+			sink = rsDecodeWs(rs, &rs->ws, C, A);
+		}
+		t = timeNow() - t;
+		printf("%d,%d,%d,%d,%s,%.1f\n", BITS_PER_SYMBOL, n, nk, nErrs,
+			   name[kes], 1e9 * t / runs);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+// -----------------------------------------------------------------------------
+{
+	if ((argc < 2) || strcmp(argv[1], "-H"))
+		printf("bits,n,nk,errors,solver,ns_per_decode\n");
+	const int n = GF_N - 1;
+	for (int nk=2; nk<n && nk<=128; nk*=2) {
+		rsCodec rs;
+		if (rsInit(&rs, n, nk))
+			return 2;
+		int t = nk / 2;
+		int errs[] = {1, t / 2, t};
+		for (int e=0, last=0; e<3; e++) {
+			if (errs[e] <= last)
+				continue;
+			bench(&rs, errs[e]);
+			last = errs[e];
+		}
+		rsFree(&rs);
+	}
+	return 0;
+}
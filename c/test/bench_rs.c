@@ -0,0 +1,204 @@
+// -----------------------------------------------------------------------------
+// Benchmark for the codec: encode and decode throughput and decode latency of
+// full-length codewords (n = GF_N-1) for several n-k and numbers of errors
+// 0 ... t = (n-k)/2, in vector (rsEncodeV(), rsDecodeV()) and exponent
+// representation (rsEncodeBatch(), rsDecodeWs()).  Build with different
+// BITS_PER_SYMBOL to compare symbol sizes (see "make bench_rs_all").
+//
+// Output is CSV, one line per (n-k, errors, api):
+//   bits,n,nk,errors,api,enc_MBps,enc_ns,dec_MBps,dec_ns,dec_p50_ns,dec_p99_ns
+// MB/s count the info part as stored (sizeof(gfSym) bytes per symbol),
+// *_ns is per codeword.  The percentiles are of single decodes, including
+// the overhead of the clock (some 20 ns).
+// Options:
+//   -H  omit the header line
+//   -j  JSON lines instead of CSV, one object per line
+//   -a  all error counts 0 ... t, instead of 0, 1, 2, t/4, t/2, 3t/4, t
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include "test_util.h"
+#include <rs/rs.h>
+#include <gf/gf.h>
+
+#define POOL		32			// number of different codewords
+#define BUDGET		0.05		// seconds per measurement (min.)
+#define SAMPLES		4096		// single decodes for the percentiles
+#define MAX_NK		128
+
+static gfSym poolV[POOL][GF_N];	// codewords with errors, vector repr.
+static gfExp poolE[POOL][GF_N];	// same in exponent repr.
+static gfExp encE[POOL][GF_N];	// same, for rsEncodeBatch() in place
+static gfSym CV[GF_N];
+static gfExp CE[GF_N];
+static double lat[SAMPLES];
+
+static int json;
+volatile int sink;				// keeps results alive
+
+
+// sort a[0] ... a[n-1] ascending (Shell sort, no stdlib here)
+// -----------------------------------------------------------------------------
+static void sort(double* a, int n)
+// -----------------------------------------------------------------------------
+{
+	for (int gap=n/2; gap>0; gap/=2) {
+		for (int i=gap; i<n; i++) {
+			double v = a[i];
+			int j = i;
+			for (; (j >= gap) && (a[j - gap] > v); j-=gap)
+				a[j] = a[j - gap];
+			a[j] = v;
+		}
+	}
+}
+
+
+// Encode or decode codeword r of the pool
+// -----------------------------------------------------------------------------
+static void encode(rsCodec* rs, int vec, int r)
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk;
+	if (vec)
+		rsEncodeV(rs, poolV[r % POOL] + nk, CV);
+	else
+		rsEncodeBatch(rs, encE[r % POOL], GF_N, 1);
+}
+
+
+// -----------------------------------------------------------------------------
+static void decode(rsCodec* rs, int vec, int r)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk;
+	if (vec) {
+		memcpy(CV, poolV[r % POOL], n * sizeof(gfSym));
+		sink = rsDecodeV(rs, &rs->ws, CV + nk, CV);
+	} else {
+		memcpy(CE, poolE[r % POOL], n * sizeof(gfExp));
+		sink = rsDecodeWs(rs, &rs->ws, CE, NULL);
+	}
+}
+
+
+// Return seconds per call of fn, run for BUDGET seconds at least
+// -----------------------------------------------------------------------------
+static double measure(void (*fn)(rsCodec*, int, int), rsCodec* rs, int vec)
+// -----------------------------------------------------------------------------
+{
+	int runs = 1;
+	for (;;) {
+		double t = timeNow();
+		for (int r=0; r<runs; r++)
+			fn(rs, vec, r);
+		t = timeNow() - t;
+		if (t >= BUDGET)
+			return t / runs;
+		runs *= (t > BUDGET / 16) ? 2 : 16;
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+static void bench(rsCodec* rs, int nErrs)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	// codewords with exactly nErrs errors at distinct locations:
+	for (int p=0; p<POOL; p++) {
+		gfSym* W = poolV[p];
+		for (int i=nk; i<n; i++)
+			W[i] = gfE2V[randE()];
+		rsEncodeV(rs, W + nk, W);
+		char hit[GF_N] = {0};
+		for (int e=0; e<nErrs; e++) {
+			int loc;
+			do {
+				loc = rand(0, n - 1);
+			} while (hit[loc]);
+			hit[loc] = 1;
+			W[loc] ^= gfE2V[randE1()];
+		}
+		for (int i=0; i<n; i++)
+			encE[p][i] = poolE[p][i] = gfV2E[W[i]];
+	}
+	static const char* name[] = {"exp", "vec"};
+	for (int vec=0; vec<=1; vec++) {
+		double tEnc = measure(encode, rs, vec);
+		double tDec = measure(decode, rs, vec);
+		const double infoMB = k * sizeof(gfSym) / 1e6;
+		int samples = SAMPLES;
+		if (samples * tDec > 4 * BUDGET)	// long codewords
+			samples = 4 * BUDGET / tDec + 20;
+		for (int s=0; s<samples; s++) {
+			double t = timeNow();
+			decode(rs, vec, s);
+			lat[s] = timeNow() - t;
+		}
+		sort(lat, samples);
+		double p50 = lat[samples / 2], p99 = lat[samples * 99 / 100];
+		if (json)
+			printf("{\"bits\":%d,\"n\":%d,\"nk\":%d,\"errors\":%d,"
+				   "\"api\":\"%s\",\"enc_MBps\":%.1f,\"enc_ns\":%.1f,"
+				   "\"dec_MBps\":%.1f,\"dec_ns\":%.1f,\"dec_p50_ns\":%.0f,"
+				   "\"dec_p99_ns\":%.0f}\n",
+				   BITS_PER_SYMBOL, n, nk, nErrs, name[vec],
+				   infoMB / tEnc, 1e9 * tEnc, infoMB / tDec, 1e9 * tDec,
+				   1e9 * p50, 1e9 * p99);
+		else
+			printf("%d,%d,%d,%d,%s,%.1f,%.1f,%.1f,%.1f,%.0f,%.0f\n",
+				   BITS_PER_SYMBOL, n, nk, nErrs, name[vec],
+				   infoMB / tEnc, 1e9 * tEnc, infoMB / tDec, 1e9 * tDec,
+				   1e9 * p50, 1e9 * p99);
+		fflush(stdout);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+// -----------------------------------------------------------------------------
+{
+	int header = 1, all = 0;
+	for (int a=1; a<argc; a++) {
+		if (! strcmp(argv[a], "-H"))
+			header = 0;
+		else if (! strcmp(argv[a], "-j"))
+			json = 1;
+		else if (! strcmp(argv[a], "-a"))
+			all = 1;
+		else {
+			fprintf(stderr, "usage: bench_rs [-H] [-j] [-a]\n");
+			return 2;
+		}
+	}
+	if (header && ! json)
+		printf("bits,n,nk,errors,api,enc_MBps,enc_ns,dec_MBps,dec_ns,"
+			   "dec_p50_ns,dec_p99_ns\n");
+	const int n = GF_N - 1;
+	for (int nk=2; nk<n && nk<=MAX_NK; nk*=2) {
+		rsCodec rs;
+		if (rsInit(&rs, n, nk))
+			return 2;
+		int t = nk / 2;
+		int errs[] = {0, 1, 2, t / 4, t / 2, 3 * t / 4, t};
+		int nE = sizeof(errs) / sizeof(errs[0]);
+		for (int e=0, last=-1; e<(all ? t + 1 : nE); e++) {
+			int nErrs = all ? e : errs[e];
+			if ((nErrs <= last) || (nErrs > t))
+				continue;
+			bench(&rs, nErrs);
+			last = nErrs;
+		}
+		rsFree(&rs);
+	}
+	return 0;
+}
@@ -0,0 +1,208 @@
+// -----------------------------------------------------------------------------
+// Test functions and application example for bch.c
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include "test_util.h"
+#include <bch/bch.h>
+#include <bch/bch_slice.h>
+#include <gf/gf.h>
+
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+#define BIT(P, i)	(((P)[(i) / 8] >> ((i) % 8)) & 1)
+
+
+// check the roots z^1 ... z^2t of bchGen
+// return 0 for success
+// -----------------------------------------------------------------------------
+int bchTestGen(bchCodec* bch)
+// -----------------------------------------------------------------------------
+{
+	const int nk = bch->nk;
+	gfExp G[GF_N];
+	for (int i=0; i<=nk; i++)
+		G[i] = BIT(bch->gen, i) ? GF_1 : GF_0;
+	if (G[nk] != GF_1)
+		return 1;
+	for (int j=1; j<=2*bch->t; j++)
+		if (gfPolEval(G, nk, GF_Z(j % (GF_N - 1))) != GF_0)
+			return 1;
+	return 0;
+}
+
+
+// encode, compare with bit by bit division, add errors, decode.
+// return 0 for success
+// -----------------------------------------------------------------------------
+int bchTest(bchCodec* bch)
+// -----------------------------------------------------------------------------
+{
+	const int n = bch->n, nk = bch->nk, k = bch->k;
+	static uint8_t A[GF_N / 8 + 1], A0[GF_N / 8 + 1];	// info bits
+	static uint8_t R[GF_N / 8 + 1], R0[GF_N / 8 + 1];	// check bits
+	const int nA = (k + 7) / 8, nR = (nk + 7) / 8;
+
+	// ---------- random info word (and garbage above bit k-1): ----------
+	for (int i=0; i<nA; i++)
+		A[i] = A0[i] = rand(0, 255);
+
+	// ---------- encode: ----------
+	bchEncode(bch, A, R);
+	char r[GF_N];						// reference: X^nk * A % bchGen
+	for (int i=0; i<nk; i++)
+		r[i] = 0;
+	for (int i=k-1; i>=0; i--) {
+		int fb = r[nk - 1] ^ BIT(A, i);
+		for (int j=nk-1; j>0; j--)
+			r[j] = r[j - 1] ^ (fb & BIT(bch->gen, j));
+		r[0] = fb;						// bchGen(0) = 1
+	}
+	for (int i=0; i<nR*8; i++)
+		if (BIT(R, i) != ((i < nk) ? r[i] : 0))
+			return 1;
+	if (nk % 8)							// garbage above bit nk-1
+		R[nR - 1] |= rand(0, 255) << (nk % 8);
+	for (int i=0; i<nR; i++)
+		R0[i] = R[i];
+
+	// ---------- decode clean codeword: ----------
+	if (bchDecode(bch, A, R) != 0)
+		return 1;
+
+	// ---------- add errors: ----------
+	int nErrs = rand(0, bch->t);
+	int nInfoErrs = 0;
+	char hit[GF_N] = {0};
+	for (int e=0; e<nErrs; e++) {
+		int loc;
+		do {
+			loc = rand(0, n - 1);
+		} while (hit[loc]);
+		hit[loc] = 1;
+		if (loc < nk) {
+			R[loc / 8] ^= 1 << (loc % 8);
+		} else {
+			A[(loc - nk) / 8] ^= 1 << ((loc - nk) % 8);
+			nInfoErrs++;
+		}
+	}
+
+	// ---------- decode: ----------
+	if (bchDecode(bch, A, R) != nInfoErrs)
+		return 1;
+
+	// ---------- verify (incl. the bits beyond the codeword): ----------
+	for (int i=0; i<nA; i++)
+		if (A[i] != A0[i])
+			return 1;
+	for (int i=0; i<nR; i++)
+		if (R[i] != R0[i])
+			return 1;
+	return 0;
+}
+
+
+// decode a batch of codewords (few or all of them with errors, up to t+2)
+// bit-sliced, compare with bchDecode()
+// return 0 for success
+// -----------------------------------------------------------------------------
+int bchTestSliced(bchCodec* bch)
+// -----------------------------------------------------------------------------
+{
+	#define MAX_CNT (BCH_LANES + 40)
+	#define MAX_B (GF_N / 8 + 4)
+	const int nk = bch->nk, k = bch->k, n = bch->n;
+	const int aStride = (k + 7) / 8 + rand(0, 3);
+	const int rStride = (nk + 7) / 8 + rand(0, 3);
+	const int cnt = rand(1, MAX_CNT);
+	const int few = rand(0, 1);				// few codewords with errors
+	static uint8_t A[MAX_CNT * MAX_B], R[MAX_CNT * MAX_B];
+	static uint8_t A2[MAX_CNT * MAX_B], R2[MAX_CNT * MAX_B];
+	int status[MAX_CNT];
+
+	for (int c=0; c<cnt; c++) {
+		uint8_t* Ac = A + c * aStride;
+		uint8_t* Rc = R + c * rStride;
+		for (int i=0; i<aStride; i++)
+			Ac[i] = rand(0, 255);
+		bchEncode(bch, Ac, Rc);
+		for (int i=(nk+7)/8; i<rStride; i++)
+			Rc[i] = rand(0, 255);
+		int nErrs = (few && rand(0, 31)) ? 0 : rand(0, bch->t + 2);
+		for (int e=0; e<nErrs; e++) {
+			int loc = rand(0, n - 1);		// may hit twice
+			if (loc < nk)
+				Rc[loc / 8] ^= 1 << (loc % 8);
+			else
+				Ac[(loc - nk) / 8] ^= 1 << ((loc - nk) % 8);
+		}
+	}
+	for (int i=0; i<cnt*aStride; i++)
+		A2[i] = A[i];
+	for (int i=0; i<cnt*rStride; i++)
+		R2[i] = R[i];
+	bchDecodeSliced(bch, A, aStride, R, rStride, cnt, status);
+	for (int c=0; c<cnt; c++)
+		if (status[c] != bchDecode(bch, A2 + c * aStride, R2 + c * rStride))
+			return 1;
+	for (int i=0; i<cnt*aStride; i++)
+		if (A[i] != A2[i])
+			return 1;
+	for (int i=0; i<cnt*rStride; i++)
+		if (R[i] != R2[i])
+			return 1;
+	return 0;
+}
+
+
+#ifndef TEST_RUNS
+  #define TEST_RUNS 1	// demo only
+#endif
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	// configured code plus some other geometries, and NAND sectors of 512
+	// bytes (GF(2^13)) and 4 KB (GF(2^16)), if the field is big enough:
+	int geo[][2] = {			// {k, t}
+		{BCH_K,			BCH_T},
+		{1,				1},
+		{GF_N / 2,		1},
+		{GF_N / 4,		MAX(1, GF_N / 4 / BITS_PER_SYMBOL)},
+		{4096,			8},
+		{4096,			40},
+		{32768,			8},
+		{32768,			40},
+	};
+	const int nGeo = sizeof(geo) / sizeof(geo[0]);
+
+	for (int g=0; g<nGeo; g++) {
+		if ((g >= 4) && (geo[g][0] + BITS_PER_SYMBOL * geo[g][1] >= GF_N))
+			continue;			// field too small for this sector
+		bchCodec bch;
+		if (bchInit(&bch, geo[g][0], geo[g][1]))
+			return 2;
+		if (bchTestGen(&bch))
+			return 3;
+		const int runs = (bch.n < 4096) ? TEST_RUNS : TEST_RUNS / 10 + 1;
+		for (int test=0; test<runs; test++)
+			if (bchTest(&bch))
+				return 1;
+		for (int test=0; test<runs/50+1; test++)
+			if (bchTestSliced(&bch))
+				return 4;
+		bchFree(&bch);
+	}
+	bchCodec bch;
+	if (! bchInit(&bch, GF_N - 1, 1) || ! bchInit(&bch, 1, 0))
+		return 2;
+	return 0;
+}
@@ -0,0 +1,151 @@
+// -----------------------------------------------------------------------------
+// Test functions and application example for ec.c
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include "test_util.h"
+#include <ec/ec.h>
+#include <gf/gf.h>
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+#define W		BITS_PER_SYMBOL
+#define MAX_S	48								// shards
+#define MAX_LEN	(3 * W * EC_PACKET + 8 * W)		// bytes per shard
+
+static uint8_t buf[MAX_S][MAX_LEN], ref[MAX_S][MAX_LEN];
+
+
+// check parity shards symbol by symbol: bit l of byte x of the packets of a
+// block makes one element, parity element i = sum(Cij * data element j)
+// return 0 for success
+// -----------------------------------------------------------------------------
+int ecTestRef(const ecCodec* ec, uint8_t** S, size_t len)
+// -----------------------------------------------------------------------------
+{
+	const int k = ec->k, m = ec->m;
+	for (size_t b0=0; b0<len; b0+=W*EC_PACKET) {
+		const size_t ps = MIN(W * EC_PACKET, len - b0) / W;
+		for (size_t x=0; x<ps; x++) {
+			for (int l=0; l<8; l++) {
+				gfVec D[k];
+				for (int j=0; j<k; j++) {
+					D[j] = 0;
+					for (int b=0; b<W; b++)
+						D[j] |= ((S[j][b0 + b * ps + x] >> l) & 1) << b;
+				}
+				for (int i=0; i<m; i++) {
+					gfVec P = 0;
+					for (int j=0; j<k; j++)
+						P = gfAddV(P, gfMulV(ec->mat[i * k + j], D[j]));
+					for (int b=0; b<W; b++)
+						if (((S[k + i][b0 + b * ps + x] >> l) & 1) != ((P >> b) & 1))
+							return 1;
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+
+// encode random shards, lose up to m of them, restore
+// return 0 for success
+// -----------------------------------------------------------------------------
+int ecTest(const ecCodec* ec)
+// -----------------------------------------------------------------------------
+{
+	const int k = ec->k, m = ec->m;
+	const size_t len = W * (rand(0, 1) ? rand(1, 8) : rand(1, MAX_LEN / W));
+	uint8_t* S[k + m];
+	for (int s=0; s<k+m; s++)
+		S[s] = buf[s];
+
+	// ---------- encode: ----------
+	for (int j=0; j<k; j++)
+		for (size_t x=0; x<len; x++)
+			S[j][x] = rand(0, 255);
+	ecEncode(ec, S, len);
+	if (ecTestRef(ec, S, len))
+		return 1;
+	for (int s=0; s<k+m; s++)
+		for (size_t x=0; x<len; x++)
+			ref[s][x] = S[s][x];
+
+	// ---------- lose shards, restore: ----------
+	int lost[m + 1], nLost = rand(0, m);
+	char isLost[k + m];
+	for (int s=0; s<k+m; s++)
+		isLost[s] = 0;
+	for (int e=0; e<nLost; e++) {
+		int s;
+		do {
+			s = rand(0, k + m - 1);
+		} while (isLost[s]);
+		isLost[s] = 1;
+		lost[e] = s;
+		for (size_t x=0; x<len; x++)
+			S[s][x] = rand(0, 255);
+	}
+	if (ecDecode(ec, S, lost, nLost, len))
+		return 1;
+	for (int s=0; s<k+m; s++)
+		for (size_t x=0; x<len; x++)
+			if (S[s][x] != ref[s][x])
+				return 1;
+
+	// ---------- invalid erasure lists: ----------
+	if (nLost > 0) {
+		lost[nLost] = lost[0];
+		if (ecDecode(ec, S, lost, nLost + 1, len) != -1)
+			return 1;
+	}
+	if (nLost == m) {
+		lost[m] = 0;
+		while (isLost[lost[m]])
+			lost[m]++;
+		if (ecDecode(ec, S, lost, m + 1, len) != -1)
+			return 1;
+	}
+	return 0;
+}
+
+
+#ifndef TEST_RUNS
+  #define TEST_RUNS 1	// demo only
+#endif
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	int geo[][2] = {			// {k, m}
+		{1,						1},
+		{2,						1},
+		{4,						2},
+		{MIN(GF_N - 4, 10),		4},
+		{MIN(GF_N / 2, 24),		MIN(GF_N / 2, 8)},
+		{MIN(GF_N - 2, 40),		2},
+	};
+	const int nGeo = sizeof(geo) / sizeof(geo[0]);
+
+	for (int g=0; g<nGeo; g++) {
+		ecCodec ec;
+		if (ecInit(&ec, geo[g][0], geo[g][1]))
+			return 2;
+		for (int test=0; test<TEST_RUNS; test++)
+			if (ecTest(&ec))
+				return 1;
+		ecFree(&ec);
+	}
+	ecCodec ec;
+	if (! ecInit(&ec, GF_N, 1) || ! ecInit(&ec, 1, 0))
+		return 2;
+	return 0;
+}
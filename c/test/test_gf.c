@@ -12,6 +12,8 @@
 #include "test_util.h"
 #include <gf/gf.h>
 
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
 // -----------------------------------------------------------------------------
 int main ()
 // -----------------------------------------------------------------------------
@@ -29,6 +31,12 @@ int main ()
 		for (int b=0; b<GF_N; b++) {
 			if (gfAdd(a, b) != gfAdd(b, a))
 				return 1;
+			// vector representation (a, b as vectors):
+			gfVec p = gfMulV(a, b);
+			if (p != gfE2V[gfMul(gfV2E[a], gfV2E[b])])
+				return 16;
+			if ((b != GF_0) && (gfDivV(p, b) != a))
+				return 16;
 			if (gfMul(a, b) != gfMul(b, a))
 				return 2;
 			if (gfMul(a, b) != gfMul(b, a))
@@ -117,5 +125,157 @@ int main ()
 		}
 	}
 
+	// -------------------- test gfPolRoots() (and gfPolRootsT()): --------------------
+  #if (GF_N <= 256)
+	static uint8_t TR[(GF_N / 2 + 1) * GF_SEQ_ROW(GF_N)];
+  #endif
+	for (int test=0; test<200; test++) {
+		nY = rand(0, GF_N - 2);
+		int nL = rand(1, MIN(nY + 1, GF_N / 2));
+		char hit[GF_N] = {0};
+		gfExp L[GF_N], L2[GF_N], X[GF_N], Mem[2 * GF_N];
+		L[0] = GF_1;
+		int nP = 0;
+		for (int r=0; r<nL; r++) {			// L = prod(X - z^i) for nL different i
+			int i;
+			do {
+				i = rand(0, nY);
+			} while (hit[i]);
+			hit[i] = 1;
+			gfExp F[2] = {GF_Z(i), GF_1};
+			nP = gfPolMul(L, nP, F, 1, L2);
+			for (int j=0; j<=nP; j++)
+				L[j] = L2[j];
+		}
+		int nX = rand(1, nL);				// stop early
+		int iy = nY + 1;					// roots come in descending order
+		if (gfPolRoots(L, nL, nY, X, nX, Mem) != nX)
+			return 14;
+		for (int r=0; r<nX; r++) {
+			int i = X[r] - GF_Z(0);
+			if ((i >= iy) || ! hit[i])
+				return 14;
+			iy = i;
+		}
+		if (gfPolRoots(L, nL, nY, X, GF_N, Mem) != nL)
+			return 14;
+  #if (GF_N <= 256)
+		gfPolEvalSeqTab(TR, nL, nY, GF_1);
+		gfExp X2[GF_N];
+		if (gfPolRootsT(L, nL, nY, nY, X2, GF_N, TR) != nL)
+			return 15;
+		if (! polCmp(X, X2, nL - 1, nL - 1))
+			return 15;
+		int nZ = rand(0, nY);				// shortened search
+		int nXZ = gfPolRoots(L, nL, nZ, X, GF_N, Mem);
+		if (gfPolRootsT(L, nL, nY, nZ, X2, GF_N, TR) != nXZ)
+			return 15;
+		if ((nXZ > 0) && ! polCmp(X, X2, nXZ - 1, nXZ - 1))
+			return 15;
+		L[0] = gfAdd(L[0], GF_1);			// now (mostly) less roots
+		if (gfPolRootsT(L, nL, nY, nY, X2, GF_N, TR) != gfPolRoots(L, nL, nY, X, GF_N, Mem))
+			return 15;
+  #endif
+	}
+
+#if (GF_N <= 256)
+	// -------------------- test gfRegionMulAdd() against gfMul(): --------------------
+	for (int test=0; test<1000; test++) {
+		uint8_t src[300], dst[300], ref[300];
+		int len = rand(0, 300);
+		gfExp c = randE();
+		for (int i=0; i<len; i++) {
+			src[i] = gfE2V[randE()];
+			dst[i] = ref[i] = gfE2V[randE()];
+			ref[i] ^= gfE2V[gfMul(c, gfV2E[src[i]])];
+		}
+		gfRegionMulAdd(dst, src, c, len);
+		for (int i=0; i<len; i++)
+			if (dst[i] != ref[i])
+				return 11;
+	}
+
+	// -------------------- test gfPolEvalSeqT() against gfPolEvalSeq(): --------------------
+	static uint8_t T[GF_N * GF_SEQ_ROW(GF_N)];
+	gfVec Yv2[M + 1];
+	for (int test=0; test<1000; test++) {
+		nA = rand(0, GF_N - 2);
+		nY = rand(0, M);
+		gfExp x = randE1();
+		randPol(A, nA);
+		gfPolEvalSeq(A, nA, Y, nY, x);
+		gfPolEvalSeqTab(T, nA, nY, x);
+		int nz = gfPolEvalSeqT(A, nA, Yv2, nY, T);
+		if (! polCmp(Y, Yv2, nY, nY) || (nz != (gfPolDeg(Y, nY) >= 0)))
+			return 12;
+		// same in vector repr., A split in two pieces:
+		uint8_t Av[GF_N], Y8[GF_SEQ_ROW(GF_N)] = {0};
+		for (int ia=0; ia<=nA; ia++)
+			Av[ia] = gfE2V[A[ia]];
+		int i0 = rand(0, nA);
+		const int w = GF_SEQ_ROW(nY);
+		gfPolEvalSeqTV(Av, i0 - 1, Y8, nY, T);
+		nz = gfPolEvalSeqTV(Av + i0, nA - i0, Y8, nY, T + i0 * w);
+		for (int iy=0; iy<=nY; iy++)
+			if (Y8[iy] != Y[iy])
+				return 13;
+		if (nz != (gfPolDeg(Y, nY) >= 0))
+			return 13;
+	}
+#endif
+
+#if (GF_N > 256)
+	// -------------------- test carry-less kernels against gfMulV(): --------------------
+	for (int test=0; test<100000; test++) {
+		gfVec a = gfE2V[randE()], b = gfE2V[randE()];
+		if (gfMulC(a, b) != gfMulV(a, b))
+			return 17;
+	}
+	static gfSym Av[GF_N], W[GF_N + 64], Rc[64];
+	static uint32_t Bc[GF_CL_ROW(64)];
+	for (int test=0; test<200; test++) {
+		// gfPolRemC() against synthetic division:
+		nA = rand(0, GF_N - 2);
+		nB = rand(1, 64);
+		gfVec Bv[64];
+		for (int i=0; i<GF_CL_ROW(nB - 1); i++) {
+			Bv[i % 64] = gfE2V[randE()];
+			Bc[i] = (i < nB) ? gfClPrep(Bv[i]) : 0;
+		}
+		for (int i=0; i<nB; i++)
+			W[i] = GF_0;
+		for (int i=0; i<=nA; i++)
+			W[nB + i] = Av[i] = gfE2V[randE()];
+		for (int i=nA+nB; i>=nB; i--)
+			for (int j=0; j<nB; j++)
+				W[i - nB + j] ^= gfMulV(W[i], Bv[j]);
+		gfPolRemC(Av, nA, Bc, nB, Rc);
+		for (int i=0; i<nB; i++)
+			if (Rc[i] != W[i])
+				return 17;
+	}
+	static uint32_t TC[(GF_CL_BLOCK + 1) * GF_CL_ROW(200)];
+	for (int test=0; test<200; test++) {
+		// gfPolEvalC() against gfPolEvalSeq(), A split in two pieces:
+		nA = rand(0, GF_N - 2);
+		nY = rand(0, 200);
+		gfExp x = randE1();
+		randPol(A, nA);
+		gfPolEvalSeq(A, nA, Y, nY, x);
+		for (int ia=0; ia<=nA; ia++)
+			Av[ia] = gfE2V[A[ia]];
+		gfPolEvalTabC(TC, nY, x);
+		uint32_t Yc[GF_CL_ROW(200)] = {0};
+		int i0 = rand(0, nA);
+		gfPolEvalC(Av + i0, nA - i0, Yc, nY, TC);
+		int nz = gfPolEvalC(Av, i0 - 1, Yc, nY, TC);
+		for (int iy=0; iy<GF_CL_ROW(nY); iy++)
+			if (Yc[iy] != ((iy <= nY) ? Y[iy] : 0))
+				return 17;
+		if (nz != (gfPolDeg(Y, nY) >= 0))
+			return 17;
+	}
+#endif
+
 	return 0;
 }
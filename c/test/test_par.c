@@ -0,0 +1,158 @@
+// -----------------------------------------------------------------------------
+// Test for rs_par.c: encode and decode buffers of codewords with 1 ... 8
+// threads, compare with rsEncodeV(), rsDecodeV().  The errors are clustered,
+// so that the threads must steal work from each other.  Also prints the
+// decoding throughput for 1, 2, 4, ... threads to show the scaling.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <unistd.h>
+#include "test_util.h"
+#include <rs/rs_par.h>
+#include <gf/gf.h>
+
+#ifndef TEST_RUNS
+  #define TEST_RUNS 1	// demo only
+#endif
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+#define MAX_SYMS	(1 << 19)
+
+static gfSym buf[MAX_SYMS];		// codewords
+static gfSym ref[MAX_SYMS];		// same, encoded with rsEncodeV()
+static int status[MAX_SYMS];
+static int nErrs[MAX_SYMS];
+
+
+// Encode random codewords with rsParEncode(), add errors, decode with
+// rsParDecode(), compare
+// return 0 for success
+// -----------------------------------------------------------------------------
+static int parTest(rsPar* par)
+// -----------------------------------------------------------------------------
+{
+	const rsCodec* rs = par->rs;
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	const int stride = n + rand(0, 3);
+	const int cnt = rand(0, MAX_SYMS / stride);
+
+	for (int c=0; c<cnt; c++) {
+		gfSym* C = buf + c * stride;
+		gfSym* Cr = ref + c * stride;
+		for (int i=0; i<n; i++)
+			C[i] = gfE2V[randE()];		// check part: garbage
+		for (int i=nk; i<n; i++)
+			Cr[i] = C[i];
+		rsEncodeV(rs, Cr + nk, Cr);
+	}
+	rsParEncode(par, buf, stride, cnt);
+
+	// errors in info part only, so that all of them are counted.  Many in
+	// the first quarter, few elsewhere:
+	int sum = 0;
+	for (int c=0; c<cnt; c++) {
+		gfSym* C = buf + c * stride;
+		for (int i=0; i<n; i++)
+			if (C[i] != ref[c * stride + i])
+				return 1;
+		int max = MIN(nk / 2, k);
+		nErrs[c] = (c < cnt / 4) ? max : (int) rand(0, MIN(max, 1));
+		for (int e=0; e<nErrs[c]; e++)
+			C[nk + k - 1 - e] ^= gfE2V[randE1()];
+		sum += nErrs[c];
+	}
+	rsStats st0, st;
+	rsParStats(par, &st0);
+	if (rsParDecode(par, buf, stride, cnt, status) != sum)
+		return 3;
+	int nClean = 0;
+	for (int c=0; c<cnt; c++) {
+		if (status[c] != nErrs[c])
+			return 3;
+		for (int i=0; i<n; i++)
+			if (buf[c * stride + i] != ref[c * stride + i])
+				return 3;
+		nClean += (nErrs[c] == 0);
+	}
+
+	// statistics of all threads:
+	rsParStats(par, &st);
+	if ((st.decoded - st0.decoded != (uint64_t) cnt) ||
+		(st.clean - st0.clean != (uint64_t) nClean) ||
+		(st.corrected - st0.corrected != (uint64_t) sum) ||
+		(st.failed != st0.failed))
+		return 4;
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	int geo[][2] = {			// {n, n-k}
+		{RS_N,			RS_N_K},
+		{GF_N / 2,		GF_N / 4},
+	};
+	const int nGeo = sizeof(geo) / sizeof(geo[0]);
+	const int threads[] = {1, 2, 3, 8};
+	rsCodec rs[nGeo];
+
+	for (int g=0; g<nGeo; g++)
+		if (rsInit(&rs[g], geo[g][0], geo[g][1]))
+			return 2;
+	for (int g=0; g<nGeo; g++) {
+		for (int t=0; t<4; t++) {
+			rsPar par;
+			if (rsParInit(&par, &rs[g], threads[t]))
+				return 2;
+			for (int test=0; test<TEST_RUNS; test++) {
+				int r = parTest(&par);
+				if (r)
+					return r;
+			}
+			rsParFree(&par);
+		}
+	}
+
+	// ---------- scaling, 1/4 of the codewords with (n-k)/2 errors: ----------
+	const rsCodec* r0 = &rs[0];
+	const int cnt = MAX_SYMS / r0->n;
+	for (int c=0; c<cnt; c++) {
+		gfSym* C = buf + c * r0->n;
+		for (int i=0; i<r0->n; i++)
+			C[i] = gfE2V[randE()];
+	}
+	int nCpu = sysconf(_SC_NPROCESSORS_ONLN);
+	printf("threads  MB/s  speedup\n");
+	double t1 = 0;
+	for (int nThreads=1; nThreads<=MIN(2 * nCpu, 64); nThreads*=2) {
+		rsPar par;
+		if (rsParInit(&par, r0, nThreads))
+			return 2;
+		rsParEncode(&par, buf, r0->n, cnt);
+		for (int c=0; c<cnt/4; c++)
+			for (int e=0; e<r0->nk/2; e++)
+				buf[c * r0->n + r0->n - 1 - e] ^= 1;
+		double t = timeNow();
+		if (rsParDecode(&par, buf, r0->n, cnt, NULL) < 0)
+			return 3;
+		t = timeNow() - t;
+		if (nThreads == 1)
+			t1 = t;
+		printf("%7d  %4.0f  %7.2f\n", nThreads,
+			   (double) cnt * r0->n * sizeof(gfSym) / t / 1e6, t1 / t);
+		rsParFree(&par);
+	}
+	for (int g=0; g<nGeo; g++)
+		rsFree(&rs[g]);
+	return 0;
+}
@@ -8,73 +8,439 @@
 // published by the Free Software Foundation.
 // -----------------------------------------------------------------------------
 
+#include <stddef.h>
 #include "test_util.h"
 #include <rs/rs.h>
 #include <gf/gf.h>
 
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
 
 // encode, add error, decode.
 // return 0 for success
 // -----------------------------------------------------------------------------
-int rsTest()
+int rsTest(rsCodec* rs)
 // -----------------------------------------------------------------------------
 {
-	static gfExp C[RS_N];		// code word
-	gfExp* A = C + RS_N_K;		// encoder needs A[-1] .. A[-(n-k)]
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	static gfExp C[GF_N];		// code word
+	gfExp* A = C + nk;			// encoder needs A[-1] .. A[-(n-k)]
 
-	static gfExp R_[RS_N_K + 1];// n-k check symbols (+1)
+	static gfExp R_[GF_N + 1];	// n-k check symbols (+1)
 	gfExp* R = R_ + 1;			// encoder needs R[-1]
 
-	static gfExp C2[RS_N];		// code word with errors
+	static gfExp C2[GF_N];		// code word with errors
 
 	dprintf("RS: --------------------\n");
 
 	// ---------- random info word: ----------
-	randPol(A, RS_K - 1);
-	PRINTPOL("RS:  A", A, RS_K - 1);
+	randPol(A, k - 1);
+	PRINTPOL("RS:  A", A, k - 1);
 
 	// ---------- encode: ----------
-	//for (int test=0; test<100000; test++)	// speed test
-	rsEncode(A, R);
+	rsEncode(rs, A, R);
 	// copy R back into C:
-	for (int i=0; i<RS_N_K; i++)
+	for (int i=0; i<nk; i++)
 		C[i] = R[i];
-	PRINTPOL("RS:  C", C, RS_N - 1);
+	PRINTPOL("RS:  C", C, n - 1);
 
 	// ---------- add error: ----------
-	static gfExp EV[RS_N];		// error vector
-	for (int i=0; i<RS_N; i++)
+	static gfExp EV[GF_N];		// error vector
+	for (int i=0; i<n; i++)
 		EV[i] = GF_0;
-	int nErrs = rand(0, RS_N_K / 2);
-	//int nErrs = RS_N_K / 2;
+	int nErrs = rand(0, nk / 2);
+	//int nErrs = nk / 2;
 	//int nErrs = 1;
 	dprintf("RS: nErrs = %d\n", nErrs);
 	for (int i=0; i<nErrs; i++) {
 		int loc;	// find not-yet-used error location
 		do {
-			loc = rand(0, RS_N - 1);
+			loc = rand(0, n - 1);
 		} while (EV[loc] != GF_0);	// already used -> try again
 		int value = randE1();		// error must be non-zero
 		EV[loc] = value;
 		//dprintf("RS: EV[%d] = %d\n", loc, value);
 	}
-	PRINTPOL("RS: EV", EV, RS_N - 1);
-	gfPolAdd(C, RS_N - 1, EV, RS_N - 1, C2);
-	PRINTPOL("RS: C2", C2, RS_N - 1);
+	PRINTPOL("RS: EV", EV, n - 1);
+	gfPolAdd(C, n - 1, EV, n - 1, C2);
+	PRINTPOL("RS: C2", C2, n - 1);
 
 	// ---------- decode: ----------
-	static gfExp A2[RS_K];				// decoded information
-	//for (int test=0; test<100000; test++)	// speed test
-	rsDecode(C2, A2);
-	PRINTPOL("RS: A2", A2, RS_K - 1);
+	static gfExp A2[GF_N];				// decoded information
+	int nCorr = rsDecode(rs, C2, A2);
+	PRINTPOL("RS: A2", A2, k - 1);
 
 	// ---------- verify: ----------
-	if (! polCmp(A, A2, RS_K - 1, RS_K - 1))
+	if (! polCmp(A, A2, k - 1, k - 1))
 	{
-		PRINTPOL("RS: A ", A,  RS_K - 1);
-		PRINTPOL("RS: A2", A2, RS_K - 1);
+		PRINTPOL("RS: A ", A,  k - 1);
+		PRINTPOL("RS: A2", A2, k - 1);
 		return 1;
 	}
+	int nInfoErrs = 0;
+	for (int i=nk; i<n; i++)
+		if (EV[i] != GF_0)
+			nInfoErrs++;
+	if (nCorr != nInfoErrs)
+		return 1;
+	if (! polCmp(C, C2, n - 1, n - 1))	// check part is corrected, too
+		return 1;
+	return 0;
+}
+
+
+// encode and decode a batch of codewords, compare with rsEncode(), rsDecode()
+// return 0 for success
+// -----------------------------------------------------------------------------
+int rsTestBatch(rsCodec* rs, rsWork* ws)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	#define CNT 8
+	const int stride = n + 3;			// some gap between codewords
+	static gfExp CB[CNT * (GF_N + 3)];	// batch of codewords
+	static gfExp CS[CNT][GF_N];			// same, encoded with rsEncode()
+	static gfExp AB[CNT * GF_N];		// decoded info words
+	static gfExp R_[GF_N + 1];
+	gfExp* R = R_ + 1;
+	int status[CNT];
+	int nErrs[CNT];
+
+	for (int c=0; c<CNT; c++) {
+		gfExp* C = CB + c * stride;
+		randPol(C + nk, k - 1);
+		randPol(C, nk - 1);				// garbage, to be overwritten
+		for (int i=0; i<k; i++)
+			CS[c][i + nk] = C[i + nk];
+		rsEncode(rs, CS[c] + nk, R);
+		for (int i=0; i<nk; i++)
+			CS[c][i] = R[i];
+	}
+	rsEncodeBatch(rs, CB, stride, CNT);
+
+	for (int c=0; c<CNT; c++) {
+		gfExp* C = CB + c * stride;
+		if (! polCmp(C, CS[c], n - 1, n - 1))
+			return 1;
+		// errors in info part only, so that all of them are counted:
+		nErrs[c] = rand(0, MIN(nk / 2, k));
+		for (int e=0; e<nErrs[c]; e++)
+			C[nk + k - 1 - e] = gfAdd(C[nk + k - 1 - e], randE1());
+	}
+	rsDecodeBatch(rs, ws, CB, stride, AB, k, CNT, status);
+
+	for (int c=0; c<CNT; c++) {
+		if (status[c] != nErrs[c])
+			return 1;
+		if (! polCmp(AB + c * k, CS[c] + nk, k - 1, k - 1))
+			return 1;
+	}
+	return 0;
+}
+
+
+// encode and decode in vector representation, compare with rsEncode()
+// return 0 for success
+// -----------------------------------------------------------------------------
+int rsTestV(rsCodec* rs, rsWork* ws)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	static gfExp C[GF_N];				// reference code word (exp. repr.)
+	gfExp* A = C + nk;
+	static gfExp R_[GF_N + 1];
+	gfExp* R = R_ + 1;
+	static gfSym Av[GF_N];				// info part in vector repr.
+	static gfSym Rv[GF_N];				// check part, not adjacent
+
+	randPol(A, k - 1);
+	for (int i=0; i<k; i++)
+		Av[i] = gfE2V[A[i]];
+	rsEncode(rs, A, R);
+	rsEncodeV(rs, Av, Rv);
+	for (int i=0; i<nk; i++)
+		if (Rv[i] != gfE2V[R[i]])
+			return 1;
+
+	// errors anywhere, but count only those in the info part:
+	int nErrs = rand(0, nk / 2);
+	int nInfoErrs = 0;
+	for (int e=0; e<nErrs; e++) {
+		int loc = rand(0, n - 1);
+		gfSym* c = (loc < nk) ? &Rv[loc] : &Av[loc - nk];
+		if ((loc >= nk) && (*c == gfE2V[A[loc - nk]]))
+			nInfoErrs++;				// not yet hit
+		else if (loc >= nk)
+			continue;					// don't hit twice
+		*c ^= gfE2V[randE1()];
+	}
+	if (rsDecodeV(rs, ws, Av, Rv) != nInfoErrs)
+		return 1;
+	for (int i=0; i<k; i++)
+		if (Av[i] != gfE2V[A[i]])
+			return 1;
+	for (int i=0; i<nk; i++)			// check part is corrected, too
+		if (Rv[i] != gfE2V[R[i]])
+			return 1;
+	return 0;
+}
+
+
+// shortened codeword of random length, compare with the zero padded one
+// return 0 for success
+// -----------------------------------------------------------------------------
+int rsTestShort(rsCodec* rs, rsWork* ws)
+// -----------------------------------------------------------------------------
+{
+	const int nk = rs->nk, k = rs->k;
+	const int n = rand(nk + 1, rs->n);	// shortened length
+	static gfSym A[GF_N], A0[GF_N];		// info part, reference
+	static gfSym R[GF_N], R0[GF_N];		// check part, reference
+
+	for (int i=0; i<k; i++)
+		A[i] = A0[i] = (i < n - nk) ? gfE2V[randE()] : GF_0;
+	rsEncodeV(rs, A0, R0);
+	rsEncodeShortV(rs, n, A, R);
+	for (int i=0; i<nk; i++)
+		if (R[i] != R0[i])
+			return 1;
+
+	// errors within the shortened codeword:
+	int nErrs = rand(0, nk / 2);
+	int nInfoErrs = 0;
+	for (int e=0; e<nErrs; e++) {
+		int loc = rand(0, n - 1);
+		gfSym* c = (loc < nk) ? &R[loc] : &A[loc - nk];
+		if ((loc >= nk) && (*c == A0[loc - nk]))
+			nInfoErrs++;
+		else if (loc >= nk)
+			continue;
+		*c ^= gfE2V[randE1()];
+	}
+	if (rsDecodeShortV(rs, ws, n, A, R) != nInfoErrs)
+		return 1;
+	for (int i=0; i<n-nk; i++)
+		if (A[i] != A0[i])
+			return 1;
+	for (int i=0; i<nk; i++)
+		if (R[i] != R0[i])
+			return 1;
+	if ((rsDecodeShortV(rs, ws, nk, A, R) != -1)
+			|| (rsDecodeShortV(rs, ws, rs->n + 1, A, R) != -1))
+		return 1;
+	return 0;
+}
+
+
+// update runs of info symbols incrementally, in exp. and vector repr.,
+// compare with encoding the whole info word
+// return 0 for success
+// -----------------------------------------------------------------------------
+int rsTestUpdate(rsCodec* rs)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	static gfExp C[GF_N], C2[GF_N], New[GF_N];	// exp. repr.
+	static gfSym A[GF_N], R[GF_N], R2[GF_N], NewV[GF_N];	// vector repr.
+
+	randPol(C + nk, k - 1);
+	rsEncodeBatch(rs, C, n, 1);
+	for (int i=0; i<k; i++)
+		A[i] = gfE2V[C[nk + i]];
+	rsEncodeV(rs, A, R);
+	for (int u=rand(1, 4); u>0; u--) {
+		const int i = rand(0, k - 1);
+		const int cnt = rand(1, (k - i < 8) ? k - i : 8);
+		for (int c=0; c<cnt; c++) {
+			New[c] = rand(0, 3) ? randE() : C[nk + i + c];	// some unchanged
+			NewV[c] = gfE2V[New[c]];
+		}
+		rsUpdate(rs, i, C + nk + i, New, cnt, C);
+		rsUpdateV(rs, i, A + i, NewV, cnt, R);
+		for (int c=0; c<cnt; c++) {
+			C[nk + i + c] = New[c];
+			A[i + c] = NewV[c];
+		}
+	}
+	for (int i=0; i<n; i++)
+		C2[i] = C[i];
+	rsEncodeBatch(rs, C2, n, 1);
+	rsEncodeV(rs, A, R2);
+	for (int i=0; i<nk; i++)
+		if ((C[i] != C2[i]) || (R[i] != R2[i]) || (gfE2V[C[i]] != R[i]))
+			return 1;
+	return 0;
+}
+
+
+// check a batch of clean codewords and ones with 1 ... n-k errors (always
+// detected), in exp. and vector repr., the buffers must stay untouched
+// return 0 for success
+// -----------------------------------------------------------------------------
+int rsTestCheck(rsCodec* rs)
+// -----------------------------------------------------------------------------
+{
+	#define MAX_CNT 40
+	const int n = rs->n, nk = rs->nk;
+	const int stride = n + rand(0, 3);
+	const int cnt = rand(1, (n * nk <= (1 << 16)) ? MAX_CNT : 3);	// big fields: slow
+	static gfSym V[MAX_CNT * (GF_N + 3)], V2[MAX_CNT * (GF_N + 3)];
+	static gfExp C[MAX_CNT * (GF_N + 3)];
+	int dirty[MAX_CNT], status[MAX_CNT], nDirty = 0;
+
+	for (int c=0; c<cnt; c++) {
+		gfSym* Vc = V + c * stride;
+		for (int i=0; i<stride; i++)		// incl. garbage between codewords
+			Vc[i] = gfE2V[randE()];
+		rsEncodeV(rs, Vc + nk, Vc);
+		int nErrs = rand(0, 1) ? 0 : rand(1, nk);
+		char hit[GF_N] = {0};
+		for (int e=0; e<nErrs; e++) {
+			int loc;
+			do {
+				loc = rand(0, n - 1);
+			} while (hit[loc]);
+			hit[loc] = 1;
+			Vc[loc] ^= gfE2V[randE1()];
+		}
+		dirty[c] = nErrs > 0;
+		nDirty += dirty[c];
+	}
+	for (int i=0; i<cnt*stride; i++) {
+		V2[i] = V[i];
+		C[i] = gfV2E[V[i]];
+	}
+
+	if (rsCheckBatchV(rs, V, stride, cnt, status) != nDirty)
+		return 1;
+	for (int c=0; c<cnt; c++)
+		if ((status[c] != dirty[c]) ||
+			(rsCheckV(rs, V + c * stride + nk, V + c * stride) != dirty[c]) ||
+			(rsCheck(rs, C + c * stride) != dirty[c]))
+			return 1;
+	if ((rsCheckBatch(rs, C, stride, cnt, status) != nDirty) ||
+		(rsCheckBatchV(rs, V, stride, cnt, NULL) != nDirty))
+		return 1;
+	for (int c=0; c<cnt; c++)
+		if (status[c] != dirty[c])
+			return 1;
+	for (int i=0; i<cnt*stride; i++)
+		if ((V[i] != V2[i]) || (C[i] != gfV2E[V[i]]))
+			return 1;
+	return 0;
+}
+
+
+// decode codewords with 0 ... n-k errors (so also uncorrectable or wrongly
+// corrected ones), compare the change of the statistics of ws
+// return 0 for success
+// -----------------------------------------------------------------------------
+int rsTestStats(rsCodec* rs, rsWork* ws)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk;
+	static gfSym V[GF_N];
+	rsStats st0, st;
+
+	for (int i=nk; i<n; i++)
+		V[i] = gfE2V[randE()];
+	rsEncodeV(rs, V + nk, V);
+	int nErrs = rand(0, 1) ? rand(0, nk / 2) : rand(0, nk);
+	char hit[GF_N] = {0};
+	for (int e=0; e<nErrs; e++) {
+		int loc;
+		do {
+			loc = rand(0, n - 1);
+		} while (hit[loc]);
+		hit[loc] = 1;
+		V[loc] ^= gfE2V[randE1()];
+	}
+	rsStatsGet(ws, &st0);
+	int r = rsDecodeV(rs, ws, V + nk, V);
+	rsStatsGet(ws, &st);
+
+	// snapshots are additive, each codeword is counted once:
+	rsStats d = {0}, sum = st0;
+	for (int i=0; i<RS_STATS_HIST; i++)
+		d.hist[i] = st.hist[i] - st0.hist[i];
+	d.decoded = st.decoded - st0.decoded;
+	d.failed = st.failed - st0.failed;
+	rsStatsAdd(&sum, &d);
+	for (int i=0; i<RS_STATS_HIST; i++)
+		if (sum.hist[i] != st.hist[i])
+			return 1;
+	uint64_t nHist = 0;
+	for (int i=0; i<RS_STATS_HIST; i++)
+		nHist += d.hist[i];
+	if ((d.decoded != 1) || (d.failed + nHist != 1) || ((r < 0) != (d.failed == 1)))
+		return 1;
+	if (2 * nErrs <= nk) {			// correctable: exactly these errors
+		const int h = MIN(nErrs, RS_STATS_HIST - 1);
+		if ((st.corrected - st0.corrected != (uint64_t) nErrs) ||
+			(st.clean - st0.clean != (uint64_t) (nErrs == 0)) ||
+			(d.hist[h] != 1) ||
+			((nErrs > 0) != (st.iter > st0.iter)))
+			return 1;
+	}
+	rsStatsReset(ws);
+	rsStatsGet(ws, &st);
+	if (st.decoded || st.corrected || st.iter || st.hist[0])
+		return 1;
+	return 0;
+}
+
+
+// errors-and-erasures decoding, in exp. or vector repr.: up to n-k erasures
+// with as many errors as still correctable.
+// return 0 for success
+// -----------------------------------------------------------------------------
+int rsTestEra(rsCodec* rs, rsWork* ws, int vec)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	static gfExp C[GF_N], C2[GF_N];		// codeword, with errors
+	static gfSym V[GF_N];				// same in vector repr.
+	int era[GF_N];
+
+	randPol(C + nk, k - 1);
+	rsEncodeBatch(rs, C, n, 1);
+	for (int i=0; i<n; i++)
+		C2[i] = C[i];
+	int nEra = rand(0, nk);
+	int nErrs = rand(0, (nk - nEra) / 2);
+	char hit[GF_N] = {0};
+	int nInfoErrs = 0;
+	for (int e=0; e<nEra+nErrs; e++) {
+		int loc;
+		do {
+			loc = rand(0, n - 1);
+		} while (hit[loc]);
+		hit[loc] = 1;
+		if (e < nEra) {
+			era[e] = loc;
+			C2[loc] = randE();			// may even be right
+		} else {
+			C2[loc] = gfAdd(C2[loc], randE1());
+		}
+		nInfoErrs += (loc >= nk) && (C2[loc] != C[loc]);
+	}
+	// some erasures listed twice, which must not cost a check symbol:
+	int nList = nEra;
+	for (int d=(nEra > 0) ? rand(0, 2) : 0; d>0; d--)
+		era[nList++] = era[rand(0, nEra - 1)];
+	int r;
+	if (vec) {
+		for (int i=0; i<n; i++)
+			V[i] = gfE2V[C2[i]];
+		r = rsDecodeEraV(rs, ws, V + nk, V, era, nList);
+		for (int i=0; i<n; i++)
+			C2[i] = gfV2E[V[i]];
+	} else {
+		r = rsDecodeEra(rs, ws, C2, NULL, era, nList);
+	}
+	if (r != nInfoErrs)
+		return 1;
+	if (! polCmp(C, C2, n - 1, n - 1))
+		return 1;
 	return 0;
 }
 
@@ -87,11 +453,48 @@ int rsTest()
 int main()
 // -----------------------------------------------------------------------------
 {
-	rsInit();
+	// configured code plus some other geometries, all used side by side:
+	int geo[][2] = {			// {n, n-k}
+		{RS_N,			RS_N_K},
+		{GF_N - 1,		2},
+		{GF_N - 1,		MIN(GF_N - 3, 1024)},	// bounded for big fields
+		{GF_N / 2,		GF_N / 4},
+		{3,				1},
+	};
+	const int nGeo = sizeof(geo) / sizeof(geo[0]);
+	rsCodec rs[nGeo];
 
+	for (int g=0; g<nGeo; g++) {
+		if (rsInit(&rs[g], geo[g][0], geo[g][1]))
+			return 2;
+		if ((rs[g].k * rs[g].nk <= (1 << 20)) && rsUpdateInit(&rs[g]))
+			return 2;		// parity columns of moderate size only
+	}
 	for (int test=0; test<TEST_RUNS; test++) {
-		if (rsTest())
-			return 1;
+		for (int g=0; g<nGeo; g++) {
+			for (int kes=0; kes<2; kes++) {	// both solvers, default last
+				rs[g].kes = kes ? RS_KES_EEA : RS_KES_BM;
+				if (rsTest(&rs[g]))
+					return 1;
+				if (rsTestBatch(&rs[g], &rs[g].ws))
+					return 3;
+				if (rsTestV(&rs[g], &rs[g].ws))
+					return 4;
+			}
+			for (int vec=0; vec<2; vec++)	// exponent and vector repr.
+				if (rsTestEra(&rs[g], &rs[g].ws, vec))
+					return 5;
+			if (rsTestShort(&rs[g], &rs[g].ws))
+				return 6;
+			if (rs[g].upd && rsTestUpdate(&rs[g]))
+				return 7;
+			if (rsTestCheck(&rs[g]))
+				return 8;
+			if (rsTestStats(&rs[g], &rs[g].ws))
+				return 9;
+		}
 	}
+	for (int g=0; g<nGeo; g++)
+		rsFree(&rs[g]);
 	return 0;
 }
@@ -0,0 +1,138 @@
+// -----------------------------------------------------------------------------
+// Multi-threaded stress test for rsDecodeWs(): several threads decode with the
+// same codec, each with its own workspace.  Also prints the decoding
+// throughput for 1, 2, 4, ... threads to show the scaling.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "test_util.h"
+#include <rs/rs.h>
+#include <gf/gf.h>
+
+#ifndef TEST_RUNS
+  #define TEST_RUNS 1	// demo only
+#endif
+
+#define MAX_THREADS	64
+#define POOL		64			// number of different test codewords
+
+static rsCodec rs;
+static gfExp pool[POOL][GF_N];	// code words with errors
+static gfExp info[POOL][GF_N];	// original info words
+
+typedef struct {
+	int		runs;		// number of codewords to decode
+	int		errors;		// out: number of wrongly decoded words
+} job;
+
+
+// -----------------------------------------------------------------------------
+static void* worker(void* arg)
+// -----------------------------------------------------------------------------
+{
+	job* j = arg;
+	gfExp mem[rsWorkSize(&rs) / sizeof(gfExp) + 1];	// private workspace
+	rsWork ws;
+	rsWorkInit(&rs, &ws, mem);
+	gfExp C[GF_N];
+	gfExp A[GF_N];
+
+	for (int r=0; r<j->runs; r++) {
+		int p = r % POOL;
+		for (int i=0; i<rs.n; i++)		// rsDecodeWs() corrects in place
+			C[i] = pool[p][i];
+		rsDecodeWs(&rs, &ws, C, A);
+		if (! polCmp(A, info[p], rs.k - 1, rs.k - 1))
+			j->errors++;
+	}
+	return NULL;
+}
+
+
+// run nThreads in parallel, return elapsed seconds or -1 on error
+// -----------------------------------------------------------------------------
+static double run(int nThreads, int runs)
+// -----------------------------------------------------------------------------
+{
+	pthread_t th[MAX_THREADS];
+	job jobs[MAX_THREADS];
+
+	double t0 = timeNow();
+	for (int t=0; t<nThreads; t++) {
+		jobs[t].runs = runs;
+		jobs[t].errors = 0;
+		if (pthread_create(&th[t], NULL, worker, &jobs[t]))
+			return -1;
+	}
+	int errors = 0;
+	for (int t=0; t<nThreads; t++) {
+		pthread_join(th[t], NULL);
+		errors += jobs[t].errors;
+	}
+	double t1 = timeNow();
+	if (errors)
+		return -1;
+	return t1 - t0;
+}
+
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	if (rsInit(&rs, RS_N, RS_N_K))
+		return 2;
+
+	// ---------- prepare code words with up to (n-k)/2 errors: ----------
+	gfExp C_[GF_N + 1];
+	gfExp* C = C_ + 1;
+	gfExp* A = C + rs.nk;		// encoder needs A[-1] .. A[-(n-k)]
+	gfExp R_[GF_N + 1];
+	gfExp* R = R_ + 1;			// encoder needs R[-1]
+	for (int p=0; p<POOL; p++) {
+		randPol(A, rs.k - 1);
+		rsEncode(&rs, A, R);
+		for (int i=0; i<rs.nk; i++)
+			C[i] = R[i];
+		for (int i=0; i<rs.k; i++)
+			info[p][i] = A[i];
+		int nErrs = (p % (rs.nk / 2 + 1));
+		for (int e=0; e<nErrs; e++) {
+			int loc = rand(0, rs.n - 1);	// may hit same location twice
+			C[loc] = gfAdd(C[loc], randE1());
+		}
+		for (int i=0; i<rs.n; i++)
+			pool[p][i] = C[i];
+	}
+
+	// ---------- stress + scaling: ----------
+	int nCpu = sysconf(_SC_NPROCESSORS_ONLN);
+	int maxThreads = 2 * nCpu;	// oversubscribe to stress
+	if ((maxThreads < 4))
+		maxThreads = 4;
+	if (maxThreads > MAX_THREADS)
+		maxThreads = MAX_THREADS;
+	int runs = 1000 * TEST_RUNS;	// per thread
+	double t1 = 0;
+	printf("threads  codewords/s  speedup\n");
+	for (int nThreads=1; nThreads<=maxThreads; nThreads*=2) {
+		double t = run(nThreads, runs);
+		if (t < 0)
+			return 1;
+		if (nThreads == 1)
+			t1 = t;
+		printf("%7d  %11.0f  %7.2f\n", nThreads, nThreads * runs / t,
+			   nThreads * t1 / t);
+	}
+	rsFree(&rs);
+	return 0;
+}
@@ -0,0 +1,177 @@
+// -----------------------------------------------------------------------------
+// Test for the wide fields (gfw.c) and their codec (rsw.c): field operations
+// against a bitwise reference, polynomial kernels against Horner's rule, and
+// encode/decode of codewords up to millions of symbols with random errors.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "test_util.h"
+#include <rs/rsw.h>
+
+#ifndef TEST_RUNS
+  #define TEST_RUNS 1	// demo only
+#endif
+
+#define MAX_N	(3 << 20)
+
+static gfw C[MAX_N];		// codeword
+static gfw ref[MAX_N];
+
+
+// random element, or random nonzero element
+// -----------------------------------------------------------------------------
+static gfw randW(int nonzero)
+// -----------------------------------------------------------------------------
+{
+	gfw w;
+	do {
+		w = ((rand(0, 0xffff) << 16) | rand(0, 0xffff)) & GFW_ORDER;
+	} while (nonzero && (w == GFW_0));
+	return w;
+}
+
+
+// a * b, bit by bit
+// -----------------------------------------------------------------------------
+static gfw mulRef(gfw a, gfw b)
+// -----------------------------------------------------------------------------
+{
+	uint64_t x = a, r = 0;
+	for (int i=0; i<GFW_BITS; i++) {
+		if (b & (1u << i))
+			r ^= x;
+		x <<= 1;
+		if (x >> GFW_BITS)
+			x ^= GFW_POL;
+	}
+	return r;
+}
+
+
+// Encode random codeword, add nErrs errors, decode, compare
+// return 0 for success
+// -----------------------------------------------------------------------------
+static int codecTest(const rswCodec* rs, int nErrs)
+// -----------------------------------------------------------------------------
+{
+	const size_t n = rs->n;
+	const int nk = rs->nk;
+	for (size_t i=nk; i<n; i++)
+		C[i] = ref[i] = randW(0);
+	rswEncode(rs, C + nk, C);
+	for (int i=0; i<nk; i++)
+		ref[i] = C[i];
+	if (rswDecode(rs, C + nk, C) != 0)
+		return 5;
+	int nInfo = 0;
+	for (int e=0; e<nErrs; e++) {
+		size_t loc;
+		do {
+			loc = ((size_t) rand(0, 0xffff) << 16 | rand(0, 0xffff)) % n;
+		} while (C[loc] != ref[loc]);
+		C[loc] ^= randW(1);
+		nInfo += loc >= (size_t) nk;
+	}
+	if (rswDecode(rs, C + nk, C) != nInfo)
+		return 6;
+	for (size_t i=0; i<n; i++)
+		if (C[i] != ref[i])
+			return 6;
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	// -------------------- field operations: --------------------
+	for (int test=0; test<100000; test++) {
+		gfw a = randW(0), b = randW(0), c = randW(1);
+		if (gfwMul(a, b) != mulRef(a, b))
+			return 1;
+		if (gfwMul(c, gfwInv(c)) != GFW_1)
+			return 1;
+	}
+	if (gfwPow(GFW_Z, GFW_ORDER) != GFW_1)
+		return 1;
+
+	// -------------------- gfwPolEvalSeq() against gfwPolEval(): --------------------
+	static gfw A[5000], T[(GFW_BLOCK + 1) * 64];
+	for (int test=0; test<100; test++) {
+		int nA = rand(0, 4999);
+		int nY = rand(0, 63);
+		gfw x = randW(1), Y[64] = {0};
+		for (int i=0; i<=nA; i++)
+			A[i] = randW(0);
+		gfwPolEvalTab(T, nY, x);
+		int i0 = rand(0, nA);
+		gfwPolEvalSeq(A + i0, nA - i0, Y, nY, T);
+		gfwPolEvalSeq(A, i0 - 1, Y, nY, T);
+		for (int iy=nY; iy>=0; iy--) {
+			if (Y[iy] != gfwPolEval(A, nA, x))
+				return 2;
+			x = gfwMul(x, GFW_Z);
+		}
+	}
+
+	// -------------------- gfwPolRoots(): --------------------
+	for (int test=0; test<100; test++) {
+		int nL = rand(1, 20);
+		size_t n = rand(nL, 100000), X[20], R[21];
+		gfw L[21] = {GFW_1};
+		for (int r=0; r<nL; r++) {			// L = prod(1 - z^X * x)
+			int dup;
+			do {
+				X[r] = rand(0, n - 1);
+				dup = 0;
+				for (int s=0; s<r; s++)
+					dup |= X[s] == X[r];
+			} while (dup);
+			gfw zx = gfwPow(GFW_Z, X[r]);
+			for (int i=r+1; i>0; i--)
+				L[i] ^= gfwMul(L[i-1], zx);
+		}
+		if (gfwPolRoots(L, nL, n, R, 21) != nL)
+			return 3;
+		for (int r=0; r<nL; r++) {
+			int hit = 0;
+			for (int s=0; s<nL; s++)
+				hit |= R[r] == X[s];
+			if (! hit || ((r > 0) && (R[r] <= R[r-1])))
+				return 3;
+		}
+	}
+
+	// -------------------- codec: --------------------
+	struct { size_t n; int nk; int runs; } geo[] = {
+		{255,		16,		100 * TEST_RUNS},
+		{5000,		32,		20 * TEST_RUNS},
+		{MAX_N,		16,		1},						// millions of symbols
+		{70000,		256,	1},
+	};
+	for (int g=0; g<(int) (sizeof(geo) / sizeof(geo[0])); g++) {
+		rswCodec rs;
+		if (rswInit(&rs, geo[g].n, geo[g].nk))
+			return 4;
+		for (int test=0; test<geo[g].runs; test++) {
+			int r = codecTest(&rs, rand(0, geo[g].nk / 2));
+			if (r)
+				return r;
+		}
+		int r = codecTest(&rs, geo[g].nk / 2);		// max. errors
+		if (r)
+			return r;
+		rswFree(&rs);
+	}
+	rswCodec rs;
+	if (! rswInit(&rs, GFW_ORDER + 1, 16) || ! rswInit(&rs, 100, 100))
+		return 4;
+	return 0;
+}
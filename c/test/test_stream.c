@@ -0,0 +1,147 @@
+// -----------------------------------------------------------------------------
+// Test for rs_stream.c: encode random streams in random pieces, compare each
+// block with rsEncodeV() per codeword, then add burst errors and decode.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#include "test_util.h"
+#include <rs/rs_stream.h>
+#include <gf/gf.h>
+
+#ifndef TEST_RUNS
+  #define TEST_RUNS 1	// demo only
+#endif
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+#define MAX_D	33
+#define MAX_LEN	(3 * GF_N * MAX_D)
+
+static gfSym in[MAX_LEN];		// stream
+static gfSym enc[2 * MAX_LEN];	// encoded stream
+
+
+// Check block (length len, m info symbols) against rsEncodeV()
+// return 0 for success
+// -----------------------------------------------------------------------------
+static int checkBlock(const rsStream* st, const gfSym* blk, int m)
+// -----------------------------------------------------------------------------
+{
+	const rsCodec* rs = st->rs;
+	const int D = st->D, nk = rs->nk, k = rs->k;
+	const int nD = (m < D) ? m : D;
+	gfSym A[GF_N], R[GF_N];
+	for (int c=0; c<nD; c++) {
+		const int kc = m / D + (c < m % D);
+		for (int i=0; i<k; i++)
+			A[i] = GF_0;
+		for (int r=0; r<kc; r++)
+			A[kc - 1 - r] = blk[r * D + c];
+		rsEncodeV(rs, A, R);
+		const int off = (c - m % nD + nD) % nD;
+		for (int j=0; j<nk; j++)
+			if (blk[m + j * nD + off] != R[nk - 1 - j])
+				return 1;
+	}
+	return 0;
+}
+
+
+// encode stream in random pieces, check, add bursts, decode
+// return 0 for success
+// -----------------------------------------------------------------------------
+static int streamTest(rsCodec* rs, int D)
+// -----------------------------------------------------------------------------
+{
+	const int n = rs->n, nk = rs->nk, k = rs->k;
+	rsStream st;
+	if (rsStreamInit(&st, rs, D))
+		return 2;
+
+	// ---------- encode: ----------
+	int len = rand(0, MAX_LEN / n * k);
+	for (int i=0; i<len; i++)
+		in[i] = gfE2V[randE()];
+	int nEnc = 0;
+	for (int i=0; i<len; ) {
+		int piece = rand(0, 3 * D);
+		if (piece > len - i)
+			piece = len - i;
+		nEnc += rsStreamEnc(&st, in + i, piece, enc + nEnc);
+		i += piece;
+	}
+	nEnc += rsStreamEncEnd(&st, enc + nEnc);
+
+	// ---------- check block by block: ----------
+	const int blkLen = n * D;
+	int pos = 0;
+	for (int i=0; pos<nEnc; ) {
+		int bl = (nEnc - pos < blkLen) ? nEnc - pos : blkLen;
+		int m = (bl == blkLen) ? k * D : -1;
+		if (m < 0)
+			m = (len - i < D) ? bl / (nk + 1) : bl - nk * D;
+		if (m != ((len - i < k * D) ? len - i : k * D))
+			return 1;
+		for (int j=0; j<m; j++)				// info passed through unchanged
+			if (enc[pos + j] != in[i + j])
+				return 1;
+		if (checkBlock(&st, enc + pos, m))
+			return 1;
+		// burst of up to (n-k)/2 symbols per codeword:
+		int burst = rand(0, ((m < D) ? m : D) * (nk / 2));
+		if (burst > bl)
+			burst = bl;
+		int at = rand(0, bl - burst);
+		for (int j=0; j<burst; j++)
+			enc[pos + at + j] ^= gfE2V[randE1()];
+		int nCorr;
+		if (rsStreamDecBlock(&st, &rs->ws, enc + pos, bl, &nCorr) != m)
+			return 3;
+		for (int j=0; j<m; j++)
+			if (enc[pos + j] != in[i + j])
+				return 3;
+		if (checkBlock(&st, enc + pos, m))	// parity repaired, too
+			return 3;
+		pos += bl;
+		i += m;
+	}
+	if (pos != nEnc)
+		return 1;
+	rsStreamFree(&st);
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+int main()
+// -----------------------------------------------------------------------------
+{
+	int geo[][2] = {			// {n, n-k}
+		{RS_N,			RS_N_K},
+		{GF_N / 2,		MIN(GF_N / 4, 256)},	// bounded for big fields
+	};
+	const int nGeo = sizeof(geo) / sizeof(geo[0]);
+	const int depth[] = {1, 2, 7, MAX_D};
+	rsCodec rs[nGeo];
+
+	for (int g=0; g<nGeo; g++)
+		if (rsInit(&rs[g], geo[g][0], geo[g][1]))
+			return 2;
+	for (int test=0; test<TEST_RUNS; test++) {
+		for (int g=0; g<nGeo; g++) {
+			for (int d=0; d<4; d++) {
+				int r = streamTest(&rs[g], depth[d]);
+				if (r)
+					return r;
+			}
+		}
+	}
+	for (int g=0; g<nGeo; g++)
+		rsFree(&rs[g]);
+	return 0;
+}
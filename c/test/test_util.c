@@ -8,6 +8,8 @@
 // published by the Free Software Foundation.
 // -----------------------------------------------------------------------------
 
+#define _POSIX_C_SOURCE 200112L
+#include <time.h>
 #include "test_util.h"
 
 unsigned int seed = 1;
@@ -48,6 +50,17 @@ void randPol(gfExp* P, int nP)
 }
 
 
+// return time in seconds (monotonic clock, for benchmarks)
+// -----------------------------------------------------------------------------
+double timeNow()
+// -----------------------------------------------------------------------------
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+
 // return 1 if A==B
 // -----------------------------------------------------------------------------
 int polCmp(gfExp* A, gfExp* B, int nA, int nB)
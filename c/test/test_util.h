@@ -33,6 +33,11 @@ gfExp randE1();
 void randPol(gfExp* P, int nP);
 
 
+// return time in seconds (monotonic clock, for benchmarks)
+// -----------------------------------------------------------------------------
+double timeNow();
+
+
 // return 1 if A==B
 // -----------------------------------------------------------------------------
 int polCmp(gfExp* A, gfExp* B, int nA, int nB);
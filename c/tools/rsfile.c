@@ -0,0 +1,371 @@
+// -----------------------------------------------------------------------------
+// rsfile: Reed-Solomon parity sidecar for files.
+//
+//   rsfile create [-r n-k] [-d depth] file [sidecar]
+//   rsfile verify file [sidecar]
+//   rsfile repair file [sidecar]
+//
+// The sidecar (default: file.rs) holds the check symbols of RS(255, 255-r)
+// codewords over GF(2^8) whose info symbols are the bytes of the file, which
+// itself stays as it is.  The file is cut into groups of k * depth bytes,
+// interleaved as in rs_stream.h: byte t of a group goes to codeword t % depth,
+// so a burst of up to depth * r/2 bytes (e.g. a bad sector) is correctable.
+// The last group is shortened: its codewords are coded at their actual length
+// (rsEncodeShortV()), with the same check symbols as if padded with zeros.
+//
+// Both files are memory mapped, the codewords are read from the mapping (with
+// depth 1 even without gathering) and the check symbols are computed directly
+// into the sidecar mapping.  Groups are processed in windows of WINDOW bytes,
+// the next one is prefetched.
+// verify maps the files copy-on-write, so nothing is written; repair corrects
+// both files in place (only the damaged symbols are written).
+//
+// Exit code: 0 ok / repaired, 1 errors found (verify), 2 uncorrectable errors,
+// 3 usage or I/O error.
+//
+// Sidecar header (32 bytes, integers little endian):
+//   0: "RSSC"  4: version 1  5: bits per symbol (8)  6: r (2)  8: depth (4)
+//  12: 0 (4)  16: file size (8)  24: 0 (8)
+// followed by r check symbols for each codeword, depth codewords per group.
+//
+// Copyright (C) 2012 Till Schmalmack
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation.
+// -----------------------------------------------------------------------------
+
+#define _POSIX_C_SOURCE 200112L
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <rs/rs.h>
+#include <gf/gf.h>
+
+#if (GF_N != 256)
+  #error "rsfile needs BITS_PER_SYMBOL 8"
+#endif
+
+#define HDR			32
+#define VERSION		1
+#define DEF_NK		32
+#define DEF_DEPTH	256
+#define MAX_DEPTH	65536			// so a group has < 2^24 bytes, its sidecar < 17 MB
+#define WINDOW		(64 << 20)		// bytes of the file per pass
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+typedef struct {
+	rsCodec		rs;
+	int			D;			// depth
+	uint64_t	size;		// file size
+	uint8_t*	data;		// file mapping
+	uint8_t*	side;		// sidecar mapping (header + check symbols)
+	uint64_t	sideSize;
+	rsWork		ws;
+	// statistics:
+	uint64_t	nCw;		// codewords
+	uint64_t	nBad;		// codewords with errors
+	uint64_t	nFixed;		// corrected bytes of the file
+	uint64_t	nFail;		// uncorrectable codewords
+} rsFile;
+
+
+// -----------------------------------------------------------------------------
+static void put(uint8_t* p, uint64_t v, int bytes)
+// -----------------------------------------------------------------------------
+{
+	for (int i=0; i<bytes; i++, v>>=8)
+		p[i] = v & 0xff;
+}
+
+
+// -----------------------------------------------------------------------------
+static uint64_t get(const uint8_t* p, int bytes)
+// -----------------------------------------------------------------------------
+{
+	uint64_t v = 0;
+	for (int i=bytes-1; i>=0; i--)
+		v = (v << 8) | p[i];
+	return v;
+}
+
+
+// Return size in bytes of the check symbols for the file
+// -----------------------------------------------------------------------------
+static uint64_t parSize(const rsFile* f)
+// -----------------------------------------------------------------------------
+{
+	const uint64_t kD = (uint64_t) f->rs.k * f->D;
+	return (f->size + kD - 1) / kD * f->D * f->rs.nk;
+}
+
+
+// Map len bytes of file fd, writable (private or shared).
+// Return NULL on error.
+// -----------------------------------------------------------------------------
+static uint8_t* mapFile(int fd, uint64_t len, int shared)
+// -----------------------------------------------------------------------------
+{
+	if (len == 0)
+		return NULL;
+	void* p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+				   shared ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED)
+		return NULL;
+	posix_madvise(p, len, POSIX_MADV_SEQUENTIAL);
+	return p;
+}
+
+
+// Prefetch the window starting at group g
+// -----------------------------------------------------------------------------
+static void prefetch(const rsFile* f, uint64_t g, uint64_t nG)
+// -----------------------------------------------------------------------------
+{
+	const uint64_t kD = (uint64_t) f->rs.k * f->D;
+	const uint64_t page = sysconf(_SC_PAGESIZE);
+	uint64_t lo = g * kD / page * page;
+	if (lo >= f->size)
+		return;
+	uint64_t len = MIN(nG * kD, f->size - lo);
+	posix_madvise(f->data + lo, len, POSIX_MADV_WILLNEED);
+}
+
+
+// Encode (dec = 0) or decode (dec = 1) group g of the file
+// -----------------------------------------------------------------------------
+static void group(rsFile* f, uint64_t g, int dec)
+// -----------------------------------------------------------------------------
+{
+	const rsCodec* rs = &f->rs;
+	const int D = f->D, nk = rs->nk, k = rs->k;
+	const uint64_t kD = (uint64_t) k * D;
+	uint8_t* blk = f->data + g * kD;
+	const uint64_t m = MIN(kD, f->size - g * kD);	// info symbols of the group
+	uint8_t W[GF_N];					// one codeword's info part, gathered
+	uint8_t R0[GF_N];
+	for (int c=0; c<D; c++) {
+		// info symbol r < kc of codeword c is A[r]; a codeword without any
+		// (in a short last group) is coded with a single 0:
+		const int kc = (int) (m / D) + ((uint64_t) c < m % D);
+		const int ks = MAX(kc, 1);
+		uint8_t* R = f->side + HDR + (g * D + c) * nk;
+		uint8_t* A = W;
+		if ((D == 1) && (kc == ks)) {
+			A = blk;					// no gathering
+		} else {
+			for (int r=0; r<kc; r++)
+				W[r] = blk[r * D + c];
+			for (int r=kc; r<ks; r++)
+				W[r] = 0;
+		}
+		f->nCw++;
+		if (! dec) {
+			rsEncodeShortV(rs, nk + ks, A, R);
+			continue;
+		}
+		for (int j=0; j<nk; j++)
+			R0[j] = R[j];
+		int nc = rsDecodeShortV(rs, &f->ws, nk + ks, A, R);
+		for (int r=kc; r<ks; r++)
+			if (A[r] != 0)				// "corrected" a missing symbol
+				nc = -1;
+		if (nc < 0) {
+			f->nFail++;
+			continue;
+		}
+		int bad = (nc > 0);
+		for (int j=0; j<nk; j++)
+			bad |= (R[j] != R0[j]);
+		f->nBad += bad;
+		f->nFixed += nc;
+		if (A == W)						// write back changed symbols only
+			for (int r=0; r<kc; r++)
+				if (blk[r * D + c] != W[r])
+					blk[r * D + c] = W[r];
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+static void run(rsFile* f, int dec)
+// -----------------------------------------------------------------------------
+{
+	const uint64_t kD = (uint64_t) f->rs.k * f->D;
+	const uint64_t nGroups = (f->size + kD - 1) / kD;
+	const uint64_t perWin = (WINDOW + kD - 1) / kD;
+	prefetch(f, 0, perWin);
+	for (uint64_t g0=0; g0<nGroups; g0+=perWin) {
+		prefetch(f, g0 + perWin, perWin);
+		for (uint64_t g=g0; g<MIN(g0 + perWin, nGroups); g++)
+			group(f, g, dec);
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+static int usage()
+// -----------------------------------------------------------------------------
+{
+	fprintf(stderr,
+		"usage: rsfile create [-r n-k] [-d depth] file [sidecar]\n"
+		"       rsfile verify file [sidecar]\n"
+		"       rsfile repair file [sidecar]\n"
+		"  -r  check symbols per codeword of 255, 2 ... 254 (default %d)\n"
+		"  -d  interleave depth, codewords per group, 1 ... %d (default %d)\n"
+		"  sidecar defaults to file.rs\n", DEF_NK, MAX_DEPTH, DEF_DEPTH);
+	return 3;
+}
+
+
+// -----------------------------------------------------------------------------
+static int fail(const char* what, const char* path)
+// -----------------------------------------------------------------------------
+{
+	fprintf(stderr, "rsfile: %s: ", path);
+	perror(what);
+	return 3;
+}
+
+
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+// -----------------------------------------------------------------------------
+{
+	if (argc < 2)
+		return usage();
+	const char* cmd = argv[1];
+	const int create = ! strcmp(cmd, "create");
+	const int repair = ! strcmp(cmd, "repair");
+	if (! create && ! repair && strcmp(cmd, "verify"))
+		return usage();
+	int nk = DEF_NK, D = DEF_DEPTH;
+	int a = 2;
+	for (; (a + 1 < argc) && (argv[a][0] == '-'); a+=2) {
+		if (! create)
+			return usage();
+		if (! strcmp(argv[a], "-r"))
+			nk = atoi(argv[a + 1]);
+		else if (! strcmp(argv[a], "-d")) {
+			long d = strtol(argv[a + 1], NULL, 10);
+			D = ((d < 1) || (d > MAX_DEPTH)) ? 0 : d;	// 0: invalid
+		}
+		else
+			return usage();
+	}
+	if ((a >= argc) || (argc - a > 2) || (nk < 2) || (nk > GF_N - 2) ||
+		(D < 1) || (D > MAX_DEPTH))
+		return usage();
+	const char* path = argv[a];
+	char sidePath[4096];
+	if (a + 1 < argc)
+		snprintf(sidePath, sizeof(sidePath), "%s", argv[a + 1]);
+	else
+		snprintf(sidePath, sizeof(sidePath), "%s.rs", path);
+
+	rsFile f = {0};
+	int fd = open(path, repair ? O_RDWR : O_RDONLY);
+	if (fd < 0)
+		return fail("open", path);
+	struct stat sb;
+	if (fstat(fd, &sb))
+		return fail("stat", path);
+	int sfd = open(sidePath, create ? (O_RDWR | O_CREAT | O_TRUNC) :
+					repair ? O_RDWR : O_RDONLY, 0644);
+	if (sfd < 0)
+		return fail("open", sidePath);
+
+	// ---------- header: ----------
+	uint8_t hdr[HDR] = {0};
+	if (create) {
+		memcpy(hdr, "RSSC", 4);
+		hdr[4] = VERSION;
+		hdr[5] = BITS_PER_SYMBOL;
+		put(hdr + 6, nk, 2);
+		put(hdr + 8, D, 4);
+		put(hdr + 16, sb.st_size, 8);
+	} else {
+		if (read(sfd, hdr, HDR) != HDR)
+			return fail("read", sidePath);
+		if (memcmp(hdr, "RSSC", 4) || (hdr[4] != VERSION) ||
+			(hdr[5] != BITS_PER_SYMBOL)) {
+			fprintf(stderr, "rsfile: %s: no sidecar\n", sidePath);
+			return 3;
+		}
+		nk = get(hdr + 6, 2);
+		const uint64_t d = get(hdr + 8, 4);
+		D = (d > MAX_DEPTH) ? 0 : d;						// 0: invalid
+		if ((nk < 2) || (nk > GF_N - 2) || (D < 1)) {
+			fprintf(stderr, "rsfile: %s: bad header\n", sidePath);
+			return 3;
+		}
+		if (get(hdr + 16, 8) != (uint64_t) sb.st_size) {
+			fprintf(stderr, "rsfile: %s: file size differs from sidecar "
+					"(truncated?)\n", path);
+			return 2;
+		}
+	}
+	if (rsInit(&f.rs, GF_N - 1, nk))
+		return fail("rsInit", path);
+	void* wsMem = malloc(rsWorkSize(&f.rs));
+	if (wsMem == NULL)
+		return fail("malloc", path);
+	rsWorkInit(&f.rs, &f.ws, wsMem);
+	f.D = D;
+	f.size = sb.st_size;
+	f.sideSize = HDR + parSize(&f);
+
+	// ---------- map: ----------
+	if (create && ftruncate(sfd, f.sideSize))
+		return fail("truncate", sidePath);
+	if (! create) {
+		struct stat ss;
+		if (fstat(sfd, &ss))
+			return fail("stat", sidePath);
+		if ((uint64_t) ss.st_size != f.sideSize) {
+			fprintf(stderr, "rsfile: %s: bad size\n", sidePath);
+			return 3;
+		}
+	}
+	f.data = mapFile(fd, f.size, repair);
+	f.side = mapFile(sfd, f.sideSize, create || repair);
+	if (((f.data == NULL) && f.size) || (f.side == NULL))
+		return fail("mmap", path);
+	if (create)
+		memcpy(f.side, hdr, HDR);
+
+	run(&f, ! create);
+
+	if (create || repair) {
+		if ((f.size && msync(f.data, f.size, MS_SYNC)) ||
+			msync(f.side, f.sideSize, MS_SYNC))
+			return fail("msync", path);
+	}
+	if (f.size)
+		munmap(f.data, f.size);
+	munmap(f.side, f.sideSize);
+	close(fd);
+	close(sfd);
+	free(wsMem);
+	rsFree(&f.rs);
+
+	if (create) {
+		printf("%s: %llu codewords RS(%d, %d), depth %d\n", sidePath,
+			   (unsigned long long) f.nCw, GF_N - 1, GF_N - 1 - nk, D);
+		return 0;
+	}
+	printf("%s: %llu codewords, %llu with errors, %llu bytes %s, "
+		   "%llu uncorrectable\n", path, (unsigned long long) f.nCw,
+		   (unsigned long long) f.nBad, (unsigned long long) f.nFixed,
+		   repair ? "repaired" : "correctable", (unsigned long long) f.nFail);
+	if (f.nFail)
+		return 2;
+	return (f.nBad && ! repair) ? 1 : 0;
+}